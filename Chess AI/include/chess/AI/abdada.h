@@ -0,0 +1,40 @@
+#ifndef ABDADA_H
+#define ABDADA_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <chess/board/bitboard/move.h>
+
+// "Currently being searched" flags for the ABDADA parallel search, keyed by
+// position and move. A thread marks a move before searching it; siblings
+// that find a move marked put it off until their other moves are done, so
+// threads at the same node spread over different moves. Collisions only
+// cost a wasted deferral, never a wrong result.
+class AbdadaTable {
+public:
+    static constexpr size_t NUM_SLOTS = 1 << 15;
+
+    static uint64_t moveHash(uint64_t key, chess::BBMove move) {
+        return key ^ (static_cast<uint64_t>(move.value) * 0x9E3779B97F4A7C15ULL);
+    }
+
+    bool isSearching(uint64_t hash) const {
+        return slots[hash & (NUM_SLOTS - 1)].load(std::memory_order_relaxed) == hash;
+    }
+
+    void startSearch(uint64_t hash) {
+        slots[hash & (NUM_SLOTS - 1)].store(hash, std::memory_order_relaxed);
+    }
+
+    // Leaves the slot alone if another move has taken it over since
+    void finishSearch(uint64_t hash) {
+        uint64_t expected = hash;
+        slots[hash & (NUM_SLOTS - 1)].compare_exchange_strong(expected, 0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> slots[NUM_SLOTS]{};
+};
+
+#endif // ABDADA_H
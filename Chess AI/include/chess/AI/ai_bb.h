@@ -4,22 +4,22 @@
 #include <chess/enums.h>
 #include <chess/board/bitboard/move.h>
 #include <chess/board/bitboard/board_state.h>
+#include <chess/board/bitboard/move_list.h>
+#include <chess/AI/pieceST.h>
+#include <chess/AI/pawn_hash.h>
+#include <chess/AI/history.h>
+#include <chess/AI/time_manager.h>
 #include <chess/utils/thread_pool.h>
 #include <vector>
 #include <memory>
 #include <array>
+#include <atomic>
 #include <future>
 
 // Forward declarations
 class BoardBB;
 class TranspositionTable;
-
-// Piece values - use constexpr to ensure compile-time constants
-constexpr int PAWN_VALUE = 100;
-constexpr int KNIGHT_VALUE = 300;
-constexpr int BISHOP_VALUE = 320;
-constexpr int ROOK_VALUE = 500;
-constexpr int QUEEN_VALUE = 900;
+class AbdadaTable;
 
 // Search constants
 constexpr int IMMEDIATE_MATE_SCORE = 100000;
@@ -29,12 +29,86 @@ constexpr int NEGATIVE_INFINITY = -POSITIVE_INFINITY;
 // Move ordering constants
 constexpr int SQUARE_CONTROLLED_BY_OPPONENT_PAWN_PENALTY = 350;
 constexpr int CAPTURED_PIECE_VALUE_MULTIPLIER = 10;
+constexpr int MAX_KILLER_PLY = 64;
+
+// Lazy SMP helpers deepen until the main thread stops them, up to this depth
+constexpr int MAX_SEARCH_DEPTH = MAX_KILLER_PLY - 1;
+
+// Nodes searched between checks of the clock and the node limit
+constexpr int LIMIT_CHECK_INTERVAL = 1024;
+
+// ABDADA only defers moves at nodes with at least this much depth left;
+// below it the bookkeeping costs more than the split saves
+constexpr int ABDADA_MIN_DEPTH = 3;
+
+// How getSearchResultParallel divides work between threads
+enum class ParallelScheduler {
+    LazySMP,    // threads share only the transposition table
+    ABDADA      // threads also defer moves another thread is searching
+};
+
+// King-dependent pawn terms, applied on top of the cached pawn structure:
+// middlegame bonus per shield pawn one and two ranks in front of a castled
+// king, and endgame bonus per rank for a passed pawn whose stop square is free
+constexpr int PAWN_SHIELD_BONUS = 12;
+constexpr int PAWN_SHIELD_FAR_BONUS = 6;
+constexpr int FREE_PASSED_PAWN_BONUS = 5;
+
+// Aspiration windows: half-width around the previous iteration's score, and
+// the first depth that uses one
+constexpr int ASPIRATION_WINDOW = 50;
+constexpr int ASPIRATION_MIN_DEPTH = 4;
+
+// Null-move pruning: minimum remaining depth, and the depth above which the
+// larger reduction is used
+constexpr int NULL_MOVE_MIN_DEPTH = 3;
+constexpr int NULL_MOVE_DEEP_REDUCTION_DEPTH = 6;
+
+// Late move reductions: only at this much remaining depth, and only from
+// this many moves searched on. The reduction itself is
+// LMR_BASE + ln(depth) * ln(moveNumber) / LMR_DIVISOR plies, looked up in a
+// table with move numbers capped at MAX_LMR_MOVES - 1.
+constexpr int LMR_MIN_DEPTH = 3;
+constexpr int LMR_MIN_MOVES = 3;
+constexpr int MAX_LMR_MOVES = 64;
+constexpr double LMR_BASE = 0.75;
+constexpr double LMR_DIVISOR = 2.25;
+
+// Forward pruning near the horizon. Margins are in centipawns, per ply of
+// remaining depth for reverse futility and by depth for the others:
+// reverse futility fails high once the static eval beats beta by 3/4 of a
+// pawn per ply; razoring and futility pruning need the static eval short of
+// alpha by roughly the piece value a quiet move would have to win back
+constexpr int REVERSE_FUTILITY_MAX_DEPTH = 6;
+constexpr int REVERSE_FUTILITY_MARGIN = PAWN_VALUE * 3 / 4;
+constexpr int RAZOR_MAX_DEPTH = 2;
+constexpr int RAZOR_MARGIN[RAZOR_MAX_DEPTH + 1] = {0, KNIGHT_VALUE, ROOK_VALUE};
+constexpr int FUTILITY_MAX_DEPTH = 3;
+constexpr int FUTILITY_MARGIN[FUTILITY_MAX_DEPTH + 1] = {0, 2 * PAWN_VALUE, KNIGHT_VALUE, ROOK_VALUE};
+
+// Late move pruning: quiets tried before the rest are dropped
+constexpr int LATE_MOVE_PRUNING_MAX_DEPTH = 4;
+constexpr int lateMovePruningCount(int depth) {
+    return 3 + depth * depth;
+}
+
+// Transposition table size; the table is kept between searches and shared
+// by all search threads
+constexpr size_t DEFAULT_TT_SIZE_MB = 16;
 
 struct Settings {
     bool useIterativeDeepening = true;
     bool useTranspositionTable = true;
     bool useMoveOrdering = true;
+    bool useNullMovePruning = true;
+    bool useLateMoveReductions = true;
+    bool useReverseFutilityPruning = true;
+    bool useRazoring = true;
+    bool useFutilityPruning = true;
+    bool useLateMovePruning = true;
     bool exitSearch = false;
+    ParallelScheduler parallelScheduler = ParallelScheduler::LazySMP;
+    size_t transpositionTableSizeMB = DEFAULT_TT_SIZE_MB;
 };
 
 class AI_BB {
@@ -43,32 +117,74 @@ public:
     ~AI_BB();
 
     std::pair<chess::BBMove, int> getSearchResult(BoardBB& board, int depth);
+    // Stops at whichever limit comes first; when time runs out before the
+    // first iteration completes, the best move found so far is returned
+    std::pair<chess::BBMove, int> getSearchResult(BoardBB& board, const SearchLimits& limits);
+    // threadCount - 1 helper threads search the same position and share the
+    // transposition table, scheduled per Settings::parallelScheduler; falls
+    // back to getSearchResult with one thread. Limits apply to the main
+    // thread, which stops the helpers when it is done.
     std::pair<chess::BBMove, int> getSearchResultParallel(BoardBB& board, int depth);
+    std::pair<chess::BBMove, int> getSearchResultParallel(BoardBB& board, const SearchLimits& limits);
     void updateSettings(const Settings& newSettings);
     void endSearch();
+    // Clears the transposition table, whose results from the previous game
+    // would only crowd out the new one's; call between games
+    void newGame();
     void setThreadCount(unsigned int numThreads);
     
     chess::BBMove getBestMove() const { return bestMove; }
     int getBestEval() const { return bestEval; }
+    int getCompletedDepth() const { return currentIterativeSearchDepth; }
+    int64_t getElapsedMs() const { return timeManager.elapsedMs(); }
     int getNumNodes() const { return numNodes; }
     int getNumQNodes() const { return numQNodes; }
     int getNumCutoffs() const { return numCutoffs; }
     int getNumTranspositions() const { return numTranspositions; }
+    int getNumNullMoveCutoffs() const { return numNullMoveCutoffs; }
+    int getNumPvsResearches() const { return numPvsResearches; }
+    int getNumAspirationResearches() const { return numAspirationResearches; }
+    int getNumLmrReductions() const { return numLmrReductions; }
+    int getNumLmrResearches() const { return numLmrResearches; }
+    int getNumReverseFutilityPrunes() const { return numReverseFutilityPrunes; }
+    int getNumRazorPrunes() const { return numRazorPrunes; }
+    int getNumFutilityPrunes() const { return numFutilityPrunes; }
+    int getNumLateMovePrunes() const { return numLateMovePrunes; }
+    // Beta cutoffs at a remaining depth, and how many came from the first
+    // move searched; their ratio measures move ordering. 0 for depths the
+    // search cannot reach.
+    int getNumFailHighs(int depth) const {
+        return depth >= 0 && depth <= MAX_SEARCH_DEPTH ? numFailHighs[depth] : 0;
+    }
+    int getNumFailHighsFirst(int depth) const {
+        return depth >= 0 && depth <= MAX_SEARCH_DEPTH ? numFailHighsFirst[depth] : 0;
+    }
+    // Nodes and quiescence nodes of the helpers in the last parallel search
+    uint64_t getNumHelperNodes() const;
+    uint64_t getNumPawnHashProbes() const { return pawnHashTable.getNumProbes(); }
+    uint64_t getNumPawnHashHits() const { return pawnHashTable.getNumHits(); }
 
 private:
     // Evaluation functions
     int evaluate(BoardBB& board);
     int countMaterial(BoardBB& board, int colorIdx);
-    float endgamePhaseWeight(int materialCountWithoutPawns) const;
-    int mopUpEval(BoardBB& board, int friendlyIdx, int opponentIdx, int myMaterial, int opponentMaterial, float endgameWeight);
-    int evaluatePieceSquareTables(BoardBB& board, int colorIdx, float endgamePhaseWeight);
-    int evaluatePieceSquareTable(const std::array<short, 64>& table, const chess::PieceList& pieceList, bool isWhite);
-    int getPieceValue(int pieceType) const;
+    int mopUpEval(BoardBB& board, int friendlyIdx, int opponentIdx, int myMaterial, int opponentMaterial, int endgamePhase);
+    chess::Score evaluatePawnStructure(const chess::BitboardState& state);
+    chess::Score evaluateKingPawnTerms(const chess::BitboardState& state, int colorIdx, uint64_t passedPawns);
     
     // Search functions
-    int searchMoves(BoardBB& board, TranspositionTable& tt, int depth, int plyFromRoot, int alpha, int beta);
+    void resetSearchState();
+    TranspositionTable* getTranspositionTable();
+    std::pair<chess::BBMove, int> runSearch(BoardBB& board, TranspositionTable& tt, const SearchLimits& limits);
+    void checkLimits();
+    void helperSearch(BoardBB& board, TranspositionTable& tt, int firstDepth);
+    int aspirationSearch(BoardBB& board, TranspositionTable& tt, int depth, int previousScore);
+    int searchMoves(BoardBB& board, TranspositionTable& tt, int depth, int plyFromRoot, int alpha, int beta,
+                    bool allowNullMove = true);
     int quiescenceSearch(BoardBB& board, TranspositionTable& tt, int alpha, int beta, int depth = 0);
-    void orderMoves(BoardBB& board, TranspositionTable& tt, std::vector<chess::BBMove>& moves);  // With TT
+    void storeKiller(int plyFromRoot, const chess::BBMove& move);
+    void updateQuietHistories(int colorIdx, chess::BBMove move, int movingPiece,
+                              PieceToHistory* const continuations[2], int bonus);
     bool isMateScore(int score) const;
     
     // Best moves tracking
@@ -78,20 +194,78 @@ private:
     int bestEvalThisIteration = 0;
     int currentIterativeSearchDepth = 0;
     
+    // Quiet moves that caused a beta cutoff, two per ply
+    chess::BBMove killerMoves[MAX_KILLER_PLY][2];
+    
+    // Quiet-move cutoff history; like the killers, per search thread
+    ButterflyHistory history;
+    
+    // Move made at each ply of the current line, for the counter-move and
+    // continuation-history lookups of the plies below it
+    struct PlayedMove {
+        int piece = chess::PIECE_NONE;   // PIECE_NONE for a null move
+        chess::BBMove move;
+    };
+    PlayedMove playedMoves[MAX_KILLER_PLY];
+    
+    // Quiet move that last refuted each opponent move, by its from/to squares
+    chess::BBMove counterMoves[64][64];
+    std::unique_ptr<ContinuationHistory> continuationHistory;
+    
+    // ABDADA: moves put off because another thread was searching them, per ply
+    chess::MoveList deferredMoves[MAX_KILLER_PLY];
+    
+    // Pawn-structure cache; every AI_BB, and so every search thread, has its own
+    PawnHashTable pawnHashTable;
+    
+    // Kept across searches, so later moves of a game start from what earlier
+    // ones learned
+    std::unique_ptr<TranspositionTable> transpositionTable;
+    size_t transpositionTableSizeMB = DEFAULT_TT_SIZE_MB;
+    
     // Settings
     bool useIterativeDeepening = true;
     bool useTranspositionTable = true;
     bool useMoveOrdering = true;
-    bool abortSearch = false;
+    bool useNullMovePruning = true;
+    bool useLateMoveReductions = true;
+    bool useReverseFutilityPruning = true;
+    bool useRazoring = true;
+    bool useFutilityPruning = true;
+    bool useLateMovePruning = true;
+    ParallelScheduler parallelScheduler = ParallelScheduler::LazySMP;
+    // Shared with the helpers while an ABDADA search runs, otherwise null
+    AbdadaTable* abdadaTable = nullptr;
+    // Set from other threads: the UI through endSearch, the main search
+    // thread to stop its helpers
+    std::atomic<bool> abortSearch{false};
+    
+    // Limits of the running search; only the main search thread has any
+    TimeManager timeManager;
+    uint64_t nodeLimit = 0;
+    bool hasLimits = false;
+    int nodesUntilLimitCheck = LIMIT_CHECK_INTERVAL;
     
     // Performance tracking
     int numNodes = 0;
     int numQNodes = 0;
     int numCutoffs = 0;
     int numTranspositions = 0;
+    int numNullMoveCutoffs = 0;
+    int numPvsResearches = 0;
+    int numAspirationResearches = 0;
+    int numLmrReductions = 0;
+    int numLmrResearches = 0;
+    int numReverseFutilityPrunes = 0;
+    int numRazorPrunes = 0;
+    int numFutilityPrunes = 0;
+    int numLateMovePrunes = 0;
+    int numFailHighs[MAX_SEARCH_DEPTH + 1] = {};
+    int numFailHighsFirst[MAX_SEARCH_DEPTH + 1] = {};
     
-    // Threading
+    // Threading: the pool runs the helpers, the caller's thread is the main search
     std::unique_ptr<ThreadPool> threadPool;
+    std::vector<std::unique_ptr<AI_BB>> helpers;
     unsigned int threadCount = 0;
 };
 
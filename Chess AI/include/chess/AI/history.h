@@ -0,0 +1,91 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <chess/board/bitboard/move.h>
+#include <chess/board/pieces/piece_const.h>
+
+// Largest bonus a single cutoff can give, reached from depth 9 on
+constexpr int HISTORY_MAX_BONUS = 1296;
+
+// History entries saturate at +-MAX_HISTORY
+constexpr int MAX_HISTORY = 16384;
+
+inline int historyBonus(int depth) {
+    return std::min(16 * depth * depth, HISTORY_MAX_BONUS);
+}
+
+// "Gravity" update shared by all history tables:
+//   entry += bonus - entry * |bonus| / MAX_HISTORY
+// keeps entries within +-MAX_HISTORY and lets older results fade as new
+// ones come in, instead of a few early cutoffs dominating the whole search
+inline void updateHistoryEntry(int16_t& entry, int bonus) {
+    entry = static_cast<int16_t>(entry + bonus - entry * std::abs(bonus) / MAX_HISTORY);
+}
+
+// Pieces are colour | type, so white 9-15 and black 17-23 map to 1-15
+inline int historyPieceIndex(int piece) {
+    return piece - chess::COLOR_WHITE;
+}
+
+// Butterfly history: how often a quiet move, by colour and from/to square,
+// has caused a beta cutoff
+class ButterflyHistory {
+public:
+    void clear() { std::memset(table, 0, sizeof(table)); }
+
+    int get(int colorIdx, chess::BBMove move) const {
+        return table[colorIdx][move.startSquare()][move.targetSquare()];
+    }
+
+    // Positive bonus for the cutoff move, negative for quiets tried before it
+    void update(int colorIdx, chess::BBMove move, int bonus) {
+        updateHistoryEntry(table[colorIdx][move.startSquare()][move.targetSquare()], bonus);
+    }
+
+private:
+    int16_t table[2][64][64] = {};
+};
+
+// Scores of (piece, target square) replies to one earlier (piece, target
+// square) move
+class PieceToHistory {
+public:
+    int get(int piece, int targetSquare) const {
+        return table[historyPieceIndex(piece)][targetSquare];
+    }
+
+    void update(int piece, int targetSquare, int bonus) {
+        updateHistoryEntry(table[historyPieceIndex(piece)][targetSquare], bonus);
+    }
+
+private:
+    int16_t table[16][64] = {};
+};
+
+// Continuation history: quiet-move scores conditioned on the move one or two
+// plies earlier, indexed by that move's piece and target square. 2 MB, so
+// owners keep it on the heap.
+class ContinuationHistory {
+public:
+    void clear() { std::memset(static_cast<void*>(table), 0, sizeof(table)); }
+
+    PieceToHistory& at(int piece, int targetSquare) {
+        return table[historyPieceIndex(piece)][targetSquare];
+    }
+
+private:
+    PieceToHistory table[16][64];
+};
+
+// The tables MovePicker orders quiets by; a continuation is null when there
+// is no earlier move of that distance, or it was a null move
+struct QuietHistory {
+    const ButterflyHistory* butterfly = nullptr;
+    const PieceToHistory* continuations[2] = {nullptr, nullptr};
+};
+
+#endif // HISTORY_H
@@ -0,0 +1,72 @@
+#ifndef MOVE_PICKER_H
+#define MOVE_PICKER_H
+
+#include <chess/board/bitboard/move.h>
+#include <chess/board/bitboard/move_list.h>
+#include <chess/board/bitboard/board_state.h>
+#include <chess/board/bitboard/move_generator_bb.h>
+#include <chess/AI/history.h>
+
+// Hands out moves one at a time in search order, generating each stage only
+// when the previous one is exhausted:
+//   TT move -> winning/equal captures (MVV-LVA) -> killers -> counter move
+//   -> remaining quiets (by history) -> losing captures (SEE < 0)
+// Quiescence search gets the winning/equal captures only.
+// The TT move, killers and counter move are checked with isLegal() instead of
+// being looked up in a generated list, so a cutoff on any of them never
+// generates quiets.
+class MovePicker {
+public:
+    // Main search
+    MovePicker(chess::BitboardState& state, chess::MoveGeneratorBB& generator,
+               chess::BBMove ttMove, const chess::BBMove* killers, chess::BBMove counterMove,
+               const QuietHistory& quietHistory, bool orderMoves = true);
+    // Quiescence search: captures only
+    MovePicker(chess::BitboardState& state, chess::MoveGeneratorBB& generator, bool orderMoves = true);
+
+    // Returns a null move (value 0) once every stage is exhausted
+    chess::BBMove next();
+
+    // Valid once a generation stage has run, which is always the case when
+    // next() returned no moves at all
+    bool inCheck() const { return sideInCheck; }
+
+private:
+    enum Stage {
+        STAGE_TT_MOVE,
+        STAGE_GEN_CAPTURES,
+        STAGE_CAPTURES,
+        STAGE_KILLERS,
+        STAGE_COUNTER_MOVE,
+        STAGE_GEN_QUIETS,
+        STAGE_QUIETS,
+        STAGE_BAD_CAPTURES,
+        STAGE_DONE
+    };
+
+    static constexpr int NUM_KILLERS = 2;
+
+    chess::BitboardState& state;
+    chess::MoveGeneratorBB& generator;
+    chess::BBMove ttMove;
+    chess::BBMove killers[NUM_KILLERS];
+    chess::BBMove counterMove;
+    QuietHistory quietHistory;
+    bool capturesOnly;
+    bool orderMoves;
+    bool sideInCheck = false;
+    int stage;
+    int killerIndex = 0;
+
+    chess::MoveList moves;
+    chess::MoveList badCaptures;
+    int scores[chess::MoveList::MAX_MOVES];
+    size_t current = 0;
+
+    bool isQuiet(const chess::BBMove& move) const;
+    void scoreCaptures();
+    void scoreQuiets();
+    chess::BBMove pickBest();
+};
+
+#endif // MOVE_PICKER_H
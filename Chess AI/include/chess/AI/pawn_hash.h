@@ -0,0 +1,41 @@
+#ifndef PAWN_HASH_H
+#define PAWN_HASH_H
+
+#include <cstdint>
+#include <vector>
+#include <chess/board/bitboard/board_state.h>
+
+// Pawn-structure terms depend on the pawns alone, which change on few moves,
+// so they are computed once per pawn key and cached
+struct PawnEntry {
+    uint64_t key = 0;
+    // Doubled, isolated, backward and passed pawns, white minus black
+    chess::Score score = 0;
+    // [colorIndex]
+    uint64_t passedPawns[2]{};
+};
+
+// Fixed-size, always-replace cache. Not thread safe: each search thread
+// owns its own table.
+class PawnHashTable {
+public:
+    explicit PawnHashTable(size_t numEntries = 1 << 14);
+
+    // Entry for the position's pawn structure, evaluated on a miss
+    const PawnEntry& probe(const chess::BitboardState& state);
+
+    void clear();
+
+    uint64_t getNumProbes() const { return numProbes; }
+    uint64_t getNumHits() const { return numHits; }
+
+private:
+    std::vector<PawnEntry> table;
+    uint64_t numProbes = 0;
+    uint64_t numHits = 0;
+};
+
+// Pawn-structure evaluation from scratch, what probe() caches
+void evaluatePawns(const chess::BitboardState& state, PawnEntry& entry);
+
+#endif // PAWN_HASH_H
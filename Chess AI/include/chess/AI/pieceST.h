@@ -3,6 +3,16 @@
 
 #include <array>
 
+// Piece values - use constexpr to ensure compile-time constants
+constexpr int PAWN_VALUE = 100;
+constexpr int KNIGHT_VALUE = 300;
+constexpr int BISHOP_VALUE = 320;
+constexpr int ROOK_VALUE = 500;
+constexpr int QUEEN_VALUE = 900;
+
+// Tables are laid out as seen from white's side of the board: the first row
+// is the eighth rank. Index with square ^ 56 for white, square for black.
+
 inline constexpr std::array<short, 64> PawnTable = {
      0,  0,  0,  0,  0,  0,  0,  0,
     50, 50, 50, 50, 50, 50, 50, 50,
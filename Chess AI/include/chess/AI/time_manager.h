@@ -0,0 +1,61 @@
+#ifndef TIME_MANAGER_H
+#define TIME_MANAGER_H
+
+#include <chrono>
+#include <cstdint>
+
+// Time kept back from every clock-based budget for move generation, the UI
+// and scheduling jitter
+constexpr int64_t MOVE_OVERHEAD_MS = 20;
+// Moves the remaining clock is spread over when there is no time control
+constexpr int DEFAULT_MOVES_TO_GO = 30;
+// The hard deadline is at most this many times the soft one
+constexpr int HARD_LIMIT_FACTOR = 4;
+
+// What bounds one search. Every field is optional, zero meaning no limit;
+// with none set the search only stops at MAX_SEARCH_DEPTH or endSearch().
+struct SearchLimits {
+    int depth = 0;                  // iterations to complete
+    int64_t moveTimeMs = 0;         // fixed time for this move
+    int64_t whiteTimeMs = 0;        // remaining clocks...
+    int64_t blackTimeMs = 0;
+    int64_t whiteIncrementMs = 0;   // ...and increments per move
+    int64_t blackIncrementMs = 0;
+    int movesToGo = 0;              // moves to the next time control, 0 for sudden death
+    uint64_t nodes = 0;             // nodes of the main search thread
+
+    bool usesClock() const { return whiteTimeMs > 0 || blackTimeMs > 0; }
+};
+
+// Turns SearchLimits into two deadlines. No new iteration is started once
+// the soft one has passed; the hard one aborts the search mid-iteration.
+// With a clock, the soft deadline is stretched while the best move keeps
+// changing between iterations and stays at its base once it settles.
+class TimeManager {
+public:
+    void start(const SearchLimits& limits, bool whiteToMove);
+
+    // After each completed iteration
+    void updateStability(bool bestMoveChanged);
+
+    bool isTimed() const { return timed; }
+    bool softLimitReached() const { return timed && elapsedMs() >= softLimitMs; }
+    bool hardLimitReached() const { return timed && elapsedMs() >= hardLimitMs; }
+
+    int64_t elapsedMs() const;
+    int64_t getSoftLimitMs() const { return softLimitMs; }
+    int64_t getHardLimitMs() const { return hardLimitMs; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point startTime;
+    bool timed = false;
+    int64_t baseSoftLimitMs = 0;
+    int64_t softLimitMs = 0;
+    int64_t hardLimitMs = 0;
+    // Decaying count of recent best-move changes
+    double instability = 0.0;
+};
+
+#endif // TIME_MANAGER_H
@@ -4,22 +4,54 @@
 #include <chess/board/bitboard/board_state.h>
 #include <chess/board/bitboard/move_generator_bb.h>
 #include <chess/board/bitboard/move_exec.h>
+#include <chess/board/bitboard/position_history.h>
+#include <chess/board/bitboard/cuckoo.h>
 #include <chess/board/bitboard/transpositionTable.h>
 #include <chess/board/bitboard/precomputed_data.h>
+#include <chess/board/bitboard/see.h>
+#include <chess/board/bitboard/bitboard.h>
 #include <chess/board/pieces/piece_const.h>
 #include <chess/AI/pieceST.h>
+#include <chess/AI/move_picker.h>
+#include <chess/AI/abdada.h>
 #include <algorithm>
 #include <memory>
 #include <vector>
+#include <iterator>
 #include <limits>
 #include <cmath>
 #include <future>
 #include <thread>
 
-AI_BB::AI_BB(unsigned int numThreads) : threadCount(numThreads) {
+namespace {
+
+// Late move reductions by remaining depth and move number,
+// LMR_BASE + ln(depth) * ln(moveNumber) / LMR_DIVISOR. std::log is not
+// constexpr, so the table is filled once at startup.
+const auto LMR_TABLE = [] {
+    std::array<std::array<int8_t, MAX_LMR_MOVES>, MAX_SEARCH_DEPTH + 1> table{};
+    for (int depth = 1; depth <= MAX_SEARCH_DEPTH; ++depth) {
+        for (int moveNumber = 1; moveNumber < MAX_LMR_MOVES; ++moveNumber) {
+            double reduction = LMR_BASE + std::log(depth) * std::log(moveNumber) / LMR_DIVISOR;
+            table[depth][moveNumber] = static_cast<int8_t>(reduction);
+        }
+    }
+    return table;
+}();
+
+} // namespace
+
+AI_BB::AI_BB(unsigned int numThreads)
+    : continuationHistory(std::make_unique<ContinuationHistory>()), threadCount(numThreads) {
     useIterativeDeepening = true;
     useTranspositionTable = true;
     useMoveOrdering = true;
+    useNullMovePruning = true;
+    useLateMoveReductions = true;
+    useReverseFutilityPruning = true;
+    useRazoring = true;
+    useFutilityPruning = true;
+    useLateMovePruning = true;
     
     if (numThreads == 0) {
         numThreads = std::thread::hardware_concurrency();
@@ -29,7 +61,7 @@ AI_BB::AI_BB(unsigned int numThreads) : threadCount(numThreads) {
     
     if (threadCount > 1) {
         try {
-            threadPool = std::make_unique<ThreadPool>(threadCount);
+            threadPool = std::make_unique<ThreadPool>(threadCount - 1);
         } catch (const std::exception& e) {
             std::cerr << "Failed to create thread pool: " << e.what() << std::endl;
             threadPool = nullptr;
@@ -48,67 +80,94 @@ void AI_BB::updateSettings(const Settings& newSettings) {
     useIterativeDeepening = newSettings.useIterativeDeepening;
     useTranspositionTable = newSettings.useTranspositionTable;
     useMoveOrdering = newSettings.useMoveOrdering;
+    useNullMovePruning = newSettings.useNullMovePruning;
+    useLateMoveReductions = newSettings.useLateMoveReductions;
+    useReverseFutilityPruning = newSettings.useReverseFutilityPruning;
+    useRazoring = newSettings.useRazoring;
+    useFutilityPruning = newSettings.useFutilityPruning;
+    useLateMovePruning = newSettings.useLateMovePruning;
+    parallelScheduler = newSettings.parallelScheduler;
     abortSearch = newSettings.exitSearch;
+    
+    // Reallocated, empty, on the next search
+    if (newSettings.transpositionTableSizeMB != transpositionTableSizeMB) {
+        transpositionTableSizeMB = newSettings.transpositionTableSizeMB;
+        transpositionTable.reset();
+    }
 }
 
 int AI_BB::evaluate(BoardBB& board) {
-    int whiteEval = 0;
-    int blackEval = 0;
+    const chess::BitboardState& state = *board.bbState;
     
-    // (0=white, 1=black), not COLOR bit flags
-    int whiteMaterial = countMaterial(board, 0);  // 0 = white array index
-    int blackMaterial = countMaterial(board, 1);  // 1 = black array index
+    // Material and piece-square terms are kept up to date by make/unmake;
+    // blend them by phase, from all middlegame with every piece on the
+    // board to all endgame with only kings and pawns left
+    int phase = std::min(state.phase, chess::MAX_PHASE);
+    int endgamePhase = chess::MAX_PHASE - phase;
+    chess::Score score = state.psqScore + evaluatePawnStructure(state);
+    int eval = (chess::mgValue(score) * phase + chess::egValue(score) * endgamePhase) / chess::MAX_PHASE;
     
-    int whiteMaterialWithoutPawns = whiteMaterial - board.bbState->pawns[0].count() * PAWN_VALUE;
-    int blackMaterialWithoutPawns = blackMaterial - board.bbState->pawns[1].count() * PAWN_VALUE;
-    
-    float whiteEndgamePhaseWeight = endgamePhaseWeight(whiteMaterialWithoutPawns);
-    float blackEndgamePhaseWeight = endgamePhaseWeight(blackMaterialWithoutPawns);
-    
-    whiteEval += whiteMaterial;
-    blackEval += blackMaterial;
-    
-    whiteEval += mopUpEval(board, 0, 1, whiteMaterial, blackMaterial, blackEndgamePhaseWeight);
-    blackEval += mopUpEval(board, 1, 0, blackMaterial, whiteMaterial, whiteEndgamePhaseWeight);
-    
-    whiteEval += evaluatePieceSquareTables(board, 0, blackEndgamePhaseWeight);
-    blackEval += evaluatePieceSquareTables(board, 1, whiteEndgamePhaseWeight);
+    if (endgamePhase > 0) {
+        int whiteMaterial = countMaterial(board, 0);
+        int blackMaterial = countMaterial(board, 1);
+        eval += mopUpEval(board, 0, 1, whiteMaterial, blackMaterial, endgamePhase);
+        eval -= mopUpEval(board, 1, 0, blackMaterial, whiteMaterial, endgamePhase);
+    }
     
-    int eval = whiteEval - blackEval;
-    int perspective = board.bbState->whiteToMove ? 1 : -1;
-    return eval * perspective;
+    return state.whiteToMove ? eval : -eval;
 }
 
-int AI_BB::countMaterial(BoardBB& board, int colorIdx) {
-    int material = 0;
-    material += board.bbState->pawns[colorIdx].count() * PAWN_VALUE;
-    material += board.bbState->knights[colorIdx].count() * KNIGHT_VALUE;
-    material += board.bbState->bishops[colorIdx].count() * BISHOP_VALUE;
-    material += board.bbState->rooks[colorIdx].count() * ROOK_VALUE;
-    material += board.bbState->queens[colorIdx].count() * QUEEN_VALUE;
-    return material;
+chess::Score AI_BB::evaluatePawnStructure(const chess::BitboardState& state) {
+    const PawnEntry& entry = pawnHashTable.probe(state);
+    return entry.score
+         + evaluateKingPawnTerms(state, 0, entry.passedPawns[0])
+         - evaluateKingPawnTerms(state, 1, entry.passedPawns[1]);
 }
 
-int AI_BB::getPieceValue(int pieceType) const {
-    switch (pieceType) {
-        case chess::PIECE_PAWN:   return PAWN_VALUE;
-        case chess::PIECE_KNIGHT: return KNIGHT_VALUE;
-        case chess::PIECE_BISHOP: return BISHOP_VALUE;
-        case chess::PIECE_ROOK:   return ROOK_VALUE;
-        case chess::PIECE_QUEEN:  return QUEEN_VALUE;
-        default:                  return 0;
+chess::Score AI_BB::evaluateKingPawnTerms(const chess::BitboardState& state, int colorIdx, uint64_t passedPawns) {
+    bool white = colorIdx == 0;
+    uint64_t ownPawns = state.pieces(colorIdx, chess::PIECE_PAWN);
+    int mg = 0;
+    int eg = 0;
+    
+    // Pawn shield, only for a king still on its first two ranks
+    int kingSquare = state.kingSquare[colorIdx];
+    int kingRelativeRank = white ? kingSquare / 8 : 7 - kingSquare / 8;
+    if (kingSquare >= 0 && kingRelativeRank <= 1) {
+        uint64_t king = 1ULL << kingSquare;
+        uint64_t near = white ? chess::shift<7>(king) | chess::shift<8>(king) | chess::shift<9>(king)
+                              : chess::shift<-9>(king) | chess::shift<-8>(king) | chess::shift<-7>(king);
+        uint64_t far = white ? chess::shift<8>(near) : chess::shift<-8>(near);
+        mg += chess::popCount(near & ownPawns) * PAWN_SHIELD_BONUS;
+        mg += chess::popCount(far & ownPawns) * PAWN_SHIELD_FAR_BONUS;
+    }
+    
+    // Passed pawns with nothing standing on their stop square
+    while (passedPawns) {
+        int sq = chess::popLSB(passedPawns);
+        int stopSquare = white ? sq + 8 : sq - 8;
+        if (state.square[stopSquare] == chess::PIECE_NONE) {
+            int relativeRank = white ? sq / 8 : 7 - sq / 8;
+            eg += relativeRank * FREE_PASSED_PAWN_BONUS;
+        }
     }
+    
+    return chess::makeScore(mg, eg);
 }
 
-float AI_BB::endgamePhaseWeight(int materialCountWithoutPawns) const {
-    const float endgameMaterialStart = ROOK_VALUE * 2 + BISHOP_VALUE + KNIGHT_VALUE;
-    const float multiplier = 1.0f / endgameMaterialStart;
-    return 1.0f - std::min(1.0f, materialCountWithoutPawns * multiplier);
+int AI_BB::countMaterial(BoardBB& board, int colorIdx) {
+    int material = 0;
+    material += board.bbState->pieceCount(colorIdx, chess::PIECE_PAWN) * PAWN_VALUE;
+    material += board.bbState->pieceCount(colorIdx, chess::PIECE_KNIGHT) * KNIGHT_VALUE;
+    material += board.bbState->pieceCount(colorIdx, chess::PIECE_BISHOP) * BISHOP_VALUE;
+    material += board.bbState->pieceCount(colorIdx, chess::PIECE_ROOK) * ROOK_VALUE;
+    material += board.bbState->pieceCount(colorIdx, chess::PIECE_QUEEN) * QUEEN_VALUE;
+    return material;
 }
 
-int AI_BB::mopUpEval(BoardBB& board, int friendlyIdx, int opponentIdx, int myMaterial, int opponentMaterial, float endgameWeight) {
+int AI_BB::mopUpEval(BoardBB& board, int friendlyIdx, int opponentIdx, int myMaterial, int opponentMaterial, int endgamePhase) {
     int mopUpScore = 0;
-    if (myMaterial > opponentMaterial + PAWN_VALUE * 2 && endgameWeight > 0) {
+    if (myMaterial > opponentMaterial + PAWN_VALUE * 2) {
         int friendlyKingSquare = board.bbState->kingSquare[friendlyIdx];
         int opponentKingSquare = board.bbState->kingSquare[opponentIdx];
         
@@ -130,63 +189,82 @@ int AI_BB::mopUpEval(BoardBB& board, int friendlyIdx, int opponentIdx, int myMat
         int rankDist = std::abs((friendlyKingSquare / 8) - (opponentKingSquare / 8));
         mopUpScore += (14 - (fileDist + rankDist)) * 4;
         
-        return static_cast<int>(mopUpScore * endgameWeight);
+        return mopUpScore * endgamePhase / chess::MAX_PHASE;
     }
     return 0;
 }
 
-int AI_BB::evaluatePieceSquareTables(BoardBB& board, int colorIdx, float endgamePhaseWeight) {
-    int value = 0;
-    bool isWhite = (colorIdx == chess::COLOR_WHITE);
-    
-    value += evaluatePieceSquareTable(PawnTable, board.bbState->pawns[colorIdx], isWhite);
-    value += evaluatePieceSquareTable(RookTable, board.bbState->rooks[colorIdx], isWhite);
-    value += evaluatePieceSquareTable(KnightTable, board.bbState->knights[colorIdx], isWhite);
-    value += evaluatePieceSquareTable(BishopTable, board.bbState->bishops[colorIdx], isWhite);
-    value += evaluatePieceSquareTable(QueenTable, board.bbState->queens[colorIdx], isWhite);
-    
-    // King evaluation with phase blending
-    int kingSq = board.bbState->kingSquare[colorIdx];
-    if (kingSq >= 0 && kingSq < 64) {
-        int sq = isWhite ? kingSq : (63 - kingSq);
-        int kingEarlyPhase = KingTable[sq];
-        value += static_cast<int>(kingEarlyPhase * (1.0f - endgamePhaseWeight));
+std::pair<chess::BBMove, int> AI_BB::getSearchResult(BoardBB& board, int depth) {
+    SearchLimits limits;
+    limits.depth = depth;
+    return getSearchResult(board, limits);
+}
+
+std::pair<chess::BBMove, int> AI_BB::getSearchResult(BoardBB& board, const SearchLimits& limits) {
+    TranspositionTable* tt = getTranspositionTable();
+    if (!tt) {
+        return {chess::BBMove(), 0};
     }
     
-    return value;
+    tt->newSearch();
+    return runSearch(board, *tt, limits);
 }
 
-int AI_BB::evaluatePieceSquareTable(const std::array<short, 64>& table, const chess::PieceList& pieceList, bool isWhite) {
-    int value = 0;
-    for (int i = 0; i < pieceList.count(); ++i) {
-        int sq = pieceList.squares[i];
-        if (!isWhite) {
-            sq = 63 - sq;
-        }
-        if (sq >= 0 && sq < 64) {
-            value += table[sq];
+TranspositionTable* AI_BB::getTranspositionTable() {
+    // Allocated on first use: helper instances search their owner's table
+    // and never need one of their own
+    if (!transpositionTable) {
+        try {
+            transpositionTable = std::make_unique<TranspositionTable>(transpositionTableSizeMB);
+        } catch (const std::exception& e) {
+            std::cerr << "[AI ERROR] Failed to initialize TT: " << e.what() << std::endl;
+            return nullptr;
         }
     }
-    return value;
+    return transpositionTable.get();
 }
 
-std::pair<chess::BBMove, int> AI_BB::getSearchResult(BoardBB& board, int depth) {
-    std::unique_ptr<TranspositionTable> transpositionTable; // size in MB
-    try {
-        transpositionTable = std::make_unique<TranspositionTable>(board, 16);
-    } catch (const std::exception& e) {
-        std::cerr << "[AI ERROR] Failed to initialize TT: " << e.what() << std::endl;
-        return {chess::BBMove(), 0};
+void AI_BB::newGame() {
+    if (transpositionTable) {
+        transpositionTable->clear();
     }
-    
+}
+
+void AI_BB::resetSearchState() {
     bestEvalThisIteration = bestEval = 0;
     bestMoveThisIteration = bestMove = chess::BBMove();
     currentIterativeSearchDepth = 0;
-    abortSearch = false;
     numNodes = 0;
     numQNodes = 0;
     numCutoffs = 0;
     numTranspositions = 0;
+    numNullMoveCutoffs = 0;
+    numPvsResearches = 0;
+    numAspirationResearches = 0;
+    numLmrReductions = 0;
+    numLmrResearches = 0;
+    numReverseFutilityPrunes = 0;
+    numRazorPrunes = 0;
+    numFutilityPrunes = 0;
+    numLateMovePrunes = 0;
+    std::fill(std::begin(numFailHighs), std::end(numFailHighs), 0);
+    std::fill(std::begin(numFailHighsFirst), std::end(numFailHighsFirst), 0);
+    std::fill(&killerMoves[0][0], &killerMoves[0][0] + MAX_KILLER_PLY * 2, chess::BBMove());
+    history.clear();
+    continuationHistory->clear();
+    std::fill(&counterMoves[0][0], &counterMoves[0][0] + 64 * 64, chess::BBMove());
+}
+
+std::pair<chess::BBMove, int> AI_BB::runSearch(BoardBB& board, TranspositionTable& tt, const SearchLimits& limits) {
+    resetSearchState();
+    abortSearch = false;
+    
+    int depth = limits.depth > 0 ? std::min(limits.depth, MAX_SEARCH_DEPTH) : MAX_SEARCH_DEPTH;
+    timeManager.start(limits, board.bbState->whiteToMove);
+    nodeLimit = limits.nodes;
+    hasLimits = timeManager.isTimed() || nodeLimit > 0;
+    nodesUntilLimitCheck = static_cast<int>(nodeLimit > 0 ? std::min<uint64_t>(nodeLimit, LIMIT_CHECK_INTERVAL)
+                                                          : LIMIT_CHECK_INTERVAL);
     
     std::vector<chess::BBMove> rootMoves;
     try {
@@ -214,7 +292,7 @@ std::pair<chess::BBMove, int> AI_BB::getSearchResult(BoardBB& board, int depth)
     if (useIterativeDeepening) {
         for (int searchDepth = 1; searchDepth <= depth; ++searchDepth) {
             try {
-                searchMoves(board, *transpositionTable, searchDepth, 0, NEGATIVE_INFINITY, POSITIVE_INFINITY);
+                aspirationSearch(board, tt, searchDepth, bestEval);
             } catch (const std::exception& e) {
                 std::cerr << "[AI ERROR] Exception at depth " << searchDepth << ": " << e.what() << std::endl;
                 break;
@@ -225,121 +303,188 @@ std::pair<chess::BBMove, int> AI_BB::getSearchResult(BoardBB& board, int depth)
             
             if (abortSearch) break;
             
+            bool bestMoveChanged = searchDepth > 1 && bestMoveThisIteration.value != bestMove.value;
             currentIterativeSearchDepth = searchDepth;
             bestMove = bestMoveThisIteration;
             bestEval = bestEvalThisIteration;
             
             if (isMateScore(bestEval)) break;
+            
+            // The next iteration would most likely not finish in time
+            timeManager.updateStability(bestMoveChanged);
+            if (timeManager.softLimitReached()) break;
         }
     } else {
-        searchMoves(board, *transpositionTable, depth, 0, NEGATIVE_INFINITY, POSITIVE_INFINITY);
+        searchMoves(board, tt, depth, 0, NEGATIVE_INFINITY, POSITIVE_INFINITY);
         bestMove = bestMoveThisIteration;
         bestEval = bestEvalThisIteration;
     }
     
+    // Stopped before the first iteration completed: a root move that beat
+    // the window of the interrupted iteration is still better than nothing
+    if (bestMove.value == 0) {
+        bestMove = bestMoveThisIteration.value != 0 ? bestMoveThisIteration : rootMoves.front();
+        bestEval = bestEvalThisIteration;
+    }
+    hasLimits = false;
+    
     return {bestMove, bestEval};
 }
 
 std::pair<chess::BBMove, int> AI_BB::getSearchResultParallel(BoardBB& board, int depth) {
-    std::vector<chess::BBMove> rootMoves;
-    try {
-        rootMoves = board.getAllLegalMoves(board.getCurrentPlayer());
-    } catch (const std::exception& e) {
-        std::cerr << "[AI PARALLEL ERROR] Exception generating moves: " << e.what() << std::endl;
+    SearchLimits limits;
+    limits.depth = depth;
+    return getSearchResultParallel(board, limits);
+}
+
+std::pair<chess::BBMove, int> AI_BB::getSearchResultParallel(BoardBB& board, const SearchLimits& limits) {
+    if (!threadPool || threadCount <= 1) {
+        return getSearchResult(board, limits);
+    }
+    
+    TranspositionTable* sharedTable = getTranspositionTable();
+    if (!sharedTable) {
         return {chess::BBMove(), 0};
     }
+    TranspositionTable& tt = *sharedTable;
+    tt.newSearch();
     
-    if (rootMoves.empty()) {
-        chess::BBMove terminalMove;
-        terminalMove.value = 1;
-        int eval = 0;
-        try {
-            if (board.isCheckMate(board.getCurrentPlayer())) {
-                eval = -IMMEDIATE_MATE_SCORE;
-            }
-        } catch (...) {}
-        return {terminalMove, eval};
+    std::unique_ptr<AbdadaTable> sharedAbdadaTable;
+    if (parallelScheduler == ParallelScheduler::ABDADA) {
+        sharedAbdadaTable = std::make_unique<AbdadaTable>();
     }
+    abdadaTable = sharedAbdadaTable.get();
     
-    if (!threadPool || threadCount <= 1 || rootMoves.size() == 1) {
-        return getSearchResult(board, depth);
+    // Helpers search the same root with the same tables and stop when this
+    // thread is done. They only contribute through the tables; the result is
+    // always this thread's own.
+    while (helpers.size() < threadCount - 1) {
+        helpers.push_back(std::make_unique<AI_BB>(1));
     }
     
-    // Parallel search: evaluate each root move on separate thread
-    // Each thread searches ONE root move at the target depth only (no iterative deepening per thread)
-    std::string boardFEN = board.getCurrentFEN();
-    std::vector<std::future<std::pair<chess::BBMove, int>>> futures;
-    futures.reserve(rootMoves.size());
+    std::vector<std::unique_ptr<BoardBB>> helperBoards;
+    std::vector<std::future<void>> futures;
+    helperBoards.reserve(helpers.size());
+    futures.reserve(helpers.size());
     
-    for (const auto& move : rootMoves) {
-        // Launch parallel search for this root move
-        futures.emplace_back(threadPool->enqueue([boardFEN, move, depth]() -> std::pair<chess::BBMove, int> {
-            try {
-                BoardBB localBoard(100, 100, 30.0f);
-                localBoard.loadFEN(boardFEN, nullptr);
-                
-                chess::UndoState undo = localBoard.executeMove(move, true);
-                
-                AI_BB localAI(1);
-                
-                std::unique_ptr<TranspositionTable> localTT;
-                try {
-                    localTT = std::make_unique<TranspositionTable>(localBoard, 16);
-                } catch (...) {
-                    localBoard.undoMove(move, undo);
-                    return {move, NEGATIVE_INFINITY};
-                }
-                
-                // Use iterative deepening for better TT utilization and move ordering
-                // After making the root move, we're at ply 1, so all searches start from ply 1
-                int eval = 0;
-                for (int searchDepth = 1; searchDepth < depth; ++searchDepth) {
-                    eval = -localAI.searchMoves(localBoard, *localTT, searchDepth, 1, NEGATIVE_INFINITY, POSITIVE_INFINITY);
-                    if (localAI.abortSearch) break;
-                }
-                
-                localBoard.undoMove(move, undo);
-                
-                return {move, eval};
-            } catch (const std::exception& e) {
-                std::cerr << "[AI PARALLEL ERROR] Exception: " << e.what() << std::endl;
-                return {move, NEGATIVE_INFINITY};
-            }
+    for (size_t i = 0; i < helpers.size(); ++i) {
+        auto helperBoard = std::make_unique<BoardBB>(100, 100, 30.0f);
+        helperBoard->copyPositionFrom(board);
+        
+        AI_BB* helper = helpers[i].get();
+        helper->useTranspositionTable = useTranspositionTable;
+        helper->useMoveOrdering = useMoveOrdering;
+        helper->useNullMovePruning = useNullMovePruning;
+        helper->useLateMoveReductions = useLateMoveReductions;
+        helper->useReverseFutilityPruning = useReverseFutilityPruning;
+        helper->useRazoring = useRazoring;
+        helper->useFutilityPruning = useFutilityPruning;
+        helper->useLateMovePruning = useLateMovePruning;
+        helper->abdadaTable = abdadaTable;
+        helper->abortSearch = false;
+        
+        // Under Lazy SMP every other helper starts a ply deeper, so the threads
+        // are spread over two depths instead of all racing through the same
+        // tree. ABDADA splits each depth through the deferral flags instead.
+        int firstDepth = abdadaTable ? 1 : 1 + static_cast<int>(i % 2);
+        BoardBB* helperBoardPtr = helperBoard.get();
+        futures.push_back(threadPool->enqueue([helper, helperBoardPtr, &tt, firstDepth]() {
+            helper->helperSearch(*helperBoardPtr, tt, firstDepth);
         }));
+        helperBoards.push_back(std::move(helperBoard));
     }
     
-    chess::BBMove bestRootMove;
-    int bestRootEval = NEGATIVE_INFINITY;
+    std::pair<chess::BBMove, int> result = runSearch(board, tt, limits);
     
+    for (auto& helper : helpers) {
+        helper->abortSearch = true;
+    }
     for (auto& future : futures) {
-        try {
-            auto [move, eval] = future.get();
-            if (eval > bestRootEval) {
-                bestRootEval = eval;
-                bestRootMove = move;
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "[AI PARALLEL ERROR] Future exception: " << e.what() << std::endl;
-        }
+        future.wait();
+    }
+    
+    abdadaTable = nullptr;
+    for (auto& helper : helpers) {
+        helper->abdadaTable = nullptr;
+    }
+    
+    return result;
+}
+
+uint64_t AI_BB::getNumHelperNodes() const {
+    uint64_t nodes = 0;
+    for (const auto& helper : helpers) {
+        nodes += static_cast<uint64_t>(helper->numNodes) + static_cast<uint64_t>(helper->numQNodes);
+    }
+    return nodes;
+}
+
+void AI_BB::helperSearch(BoardBB& board, TranspositionTable& tt, int firstDepth) {
+    resetSearchState();
+    
+    int score = 0;
+    for (int searchDepth = firstDepth; searchDepth <= MAX_SEARCH_DEPTH && !abortSearch; ++searchDepth) {
+        score = aspirationSearch(board, tt, searchDepth, score);
+    }
+}
+
+int AI_BB::aspirationSearch(BoardBB& board, TranspositionTable& tt, int depth, int previousScore) {
+    // Early iterations are cheap and their scores swing too much to centre
+    // a window on; mate scores do not sit in a narrow window either
+    if (depth < ASPIRATION_MIN_DEPTH || isMateScore(previousScore)) {
+        return searchMoves(board, tt, depth, 0, NEGATIVE_INFINITY, POSITIVE_INFINITY);
     }
     
-    std::cout << "[AI PARALLEL] Search complete. Best eval: " << bestRootEval << std::endl;
-    return {bestRootMove, bestRootEval};
+    int delta = ASPIRATION_WINDOW;
+    int alpha = std::max(previousScore - delta, NEGATIVE_INFINITY);
+    int beta = std::min(previousScore + delta, POSITIVE_INFINITY);
+    
+    while (true) {
+        int score = searchMoves(board, tt, depth, 0, alpha, beta);
+        if (abortSearch) {
+            return score;
+        }
+        
+        // Widen only the side that failed, doubling the step each time
+        if (score <= alpha) {
+            alpha = std::max(score - delta, NEGATIVE_INFINITY);
+        } else if (score >= beta) {
+            beta = std::min(score + delta, POSITIVE_INFINITY);
+        } else {
+            return score;
+        }
+        numAspirationResearches++;
+        delta *= 2;
+    }
 }
 
-int AI_BB::searchMoves(BoardBB& board, TranspositionTable& tt, int depth, int plyFromRoot, int alpha, int beta) {
+int AI_BB::searchMoves(BoardBB& board, TranspositionTable& tt, int depth, int plyFromRoot, int alpha, int beta,
+                       bool allowNullMove) {
     numNodes++;
+    if (hasLimits && --nodesUntilLimitCheck <= 0) {
+        checkLimits();
+    }
     
     if (abortSearch) {
         return 0;
     }
     
-    if (plyFromRoot > 0 && !board.bbState->repetitionHistory.empty()) {
-        if (std::find(board.bbState->repetitionHistory.begin(),
-                     board.bbState->repetitionHistory.end(),
-                     board.bbState->zobristKey) != board.bbState->repetitionHistory.end()) {
+    if (plyFromRoot > 0) {
+        // Positions before the last pawn move or capture can never recur
+        int reversiblePlies = board.bbState->fiftyMoveCounter;
+        
+        // Any repetition scores as a draw
+        if (board.history->isRepetition(board.bbState->zobristKey, reversiblePlies)) {
             return 0;
         }
+        // If the side to move can repeat a position with its next move,
+        // it can always hold at least a draw
+        if (alpha < 0 && chess::hasUpcomingRepetition(*board.bbState, *board.history, reversiblePlies)) {
+            alpha = 0;
+            if (alpha >= beta) {
+                return alpha;
+            }
+        }
     }
     
     if (plyFromRoot > 0) {
@@ -350,70 +495,284 @@ int AI_BB::searchMoves(BoardBB& board, TranspositionTable& tt, int depth, int pl
         }
     }
     
-    int ttVal = tt.probeEval(depth, plyFromRoot, alpha, beta);
-    if (ttVal != tt.LOOKUP_FAILED) {
-        numTranspositions++;
-        if (plyFromRoot == 0) {
-            bestMoveThisIteration = tt.getStoredMove();
-            bestEvalThisIteration = tt.getStoredValue();
+    uint64_t key = board.bbState->zobristKey;
+    
+    // The root always searches, so its best move is this thread's own even
+    // when helper threads have already stored a deeper result for it
+    if (plyFromRoot > 0) {
+        int ttVal = tt.probeEval(key, depth, plyFromRoot, alpha, beta);
+        if (ttVal != tt.LOOKUP_FAILED) {
+            numTranspositions++;
+            return ttVal;
         }
-        return ttVal;
     }
     
     if (depth == 0) {
         return quiescenceSearch(board, tt, alpha, beta, 0);
     }
     
-    std::vector<chess::BBMove> moves;
-    try {
-        moves = board.getAllLegalMoves(board.getCurrentPlayer());
-    } catch (const std::exception& e) {
-        std::cerr << "[SEARCH ERROR] Exception in getAllLegalMoves: " << e.what() << std::endl;
-        return 0;
-    } catch (...) {
-        std::cerr << "[SEARCH ERROR] Unknown exception in getAllLegalMoves" << std::endl;
-        return 0;
+    const chess::BitboardState& state = *board.bbState;
+    int us = state.whiteToMove ? 0 : 1;
+    bool inCheck = (chess::attackersTo(state, state.kingSquare[us], state.allPiecesBitboard) &
+                    state.colorBitboards[us ^ 1]) != 0;
+    
+    // The static eval is only trusted below the root and out of check; the
+    // forward pruning below stays out of PV nodes, whose exact score matters
+    bool hasStaticEval = plyFromRoot > 0 && !inCheck;
+    int staticEval = hasStaticEval ? evaluate(board) : 0;
+    bool canPrune = hasStaticEval && beta - alpha == 1;
+    
+    // Reverse futility pruning: so far above beta that no reply at this
+    // small a depth is expected to bring it back down
+    if (useReverseFutilityPruning && canPrune && depth <= REVERSE_FUTILITY_MAX_DEPTH && !isMateScore(beta) &&
+        staticEval - REVERSE_FUTILITY_MARGIN * depth >= beta) {
+        numReverseFutilityPrunes++;
+        return beta;
     }
     
-    orderMoves(board, tt, moves);
+    // Razoring: so far below alpha that only a capture sequence could help,
+    // so let quiescence search confirm the fail low
+    if (useRazoring && canPrune && depth <= RAZOR_MAX_DEPTH && !isMateScore(alpha) &&
+        staticEval + RAZOR_MARGIN[depth] <= alpha) {
+        int eval = quiescenceSearch(board, tt, alpha, beta);
+        if (abortSearch) {
+            return 0;
+        }
+        if (eval <= alpha) {
+            numRazorPrunes++;
+            return alpha;
+        }
+    }
     
-    // Checkmate and stalemate detection
-    if (moves.empty()) {
-        try {
-            if (board.isCheckMate(board.getCurrentPlayer())) {
-                return -(IMMEDIATE_MATE_SCORE - plyFromRoot);
+    // Null-move pruning: if passing the turn still fails high at reduced
+    // depth, some real move would too. Not done in check, twice in a row,
+    // or with only king and pawns left, where zugzwang makes passing the
+    // best option and the assumption breaks.
+    if (useNullMovePruning && allowNullMove && hasStaticEval && depth >= NULL_MOVE_MIN_DEPTH &&
+        !isMateScore(beta)) {
+        uint64_t nonPawnMaterial = state.colorBitboards[us] &
+                                   ~(state.pieces(us, chess::PIECE_PAWN) | state.pieces(us, chess::PIECE_KING));
+        
+        if (nonPawnMaterial && staticEval >= beta) {
+            int reduction = depth > NULL_MOVE_DEEP_REDUCTION_DEPTH ? 3 : 2;
+            if (plyFromRoot < MAX_KILLER_PLY) {
+                playedMoves[plyFromRoot] = PlayedMove();
             }
-        } catch (...) {}
-        return 0;
+            chess::UndoState undo = board.executeNullMove();
+            int eval = -searchMoves(board, tt, std::max(depth - 1 - reduction, 0), plyFromRoot + 1,
+                                    -beta, -beta + 1, false);
+            board.undoNullMove(undo);
+            
+            if (abortSearch) {
+                return 0;
+            }
+            if (eval >= beta) {
+                numNullMoveCutoffs++;
+                return beta;
+            }
+        }
+    }
+    
+    // Moves come from bbState's side to move; BoardBB::currentPlayer is
+    // only the UI's turn and does not change during search
+    chess::BBMove ttMove = useTranspositionTable ? tt.getStoredMove(key) : chess::BBMove();
+    const chess::BBMove* killers = plyFromRoot < MAX_KILLER_PLY ? killerMoves[plyFromRoot] : nullptr;
+    
+    // Counter move and continuation histories follow the moves one and two
+    // plies back; none after the root or a null move
+    chess::BBMove counterMove;
+    PieceToHistory* continuations[2] = {nullptr, nullptr};
+    for (int i = 0; i < 2; ++i) {
+        int ply = plyFromRoot - 1 - i;
+        if (ply < 0 || ply >= MAX_KILLER_PLY || playedMoves[ply].piece == chess::PIECE_NONE) {
+            continue;
+        }
+        const PlayedMove& previous = playedMoves[ply];
+        continuations[i] = &continuationHistory->at(previous.piece, previous.move.targetSquare());
+        if (i == 0) {
+            counterMove = counterMoves[previous.move.startSquare()][previous.move.targetSquare()];
+        }
     }
+    QuietHistory quietHistory;
+    quietHistory.butterfly = &history;
+    quietHistory.continuations[0] = continuations[0];
+    quietHistory.continuations[1] = continuations[1];
+    
+    MovePicker picker(*board.bbState, *board.bbGenerator, ttMove, killers, counterMove, quietHistory,
+                      useMoveOrdering);
     
     int evalType = tt.UPPER_BOUND;
     chess::BBMove bestMoveInThisPosition;
-    
-    for (size_t i = 0; i < moves.size(); ++i) {
-        chess::UndoState undo = board.executeMove(moves[i], true);
-        int eval = -searchMoves(board, tt, depth - 1, plyFromRoot + 1, -beta, -alpha);
-        board.undoMove(moves[i], undo);
+    int numMovesSearched = 0;
+    // Quiets that failed to cut off, penalised in the history if a later one does
+    chess::MoveList quietsSearched;
+    
+    // ABDADA: once the first move is searched, a move another thread is
+    // already searching is put off until the rest are done, by when its
+    // result is likely waiting in the table
+    chess::MoveList* deferred = nullptr;
+    if (abdadaTable && depth >= ABDADA_MIN_DEPTH && plyFromRoot < MAX_KILLER_PLY) {
+        deferred = &deferredMoves[plyFromRoot];
+        deferred->clear();
+    }
+    size_t numDeferredSearched = 0;
+    bool pickerDone = false;
+    
+    while (true) {
+        chess::BBMove move = pickerDone ? chess::BBMove() : picker.next();
+        bool isDeferred = false;
+        if (move.value == 0) {
+            pickerDone = true;
+            if (!deferred || numDeferredSearched == deferred->size()) {
+                break;
+            }
+            move = (*deferred)[numDeferredSearched++];
+            isDeferred = true;
+        }
+        
+        bool isQuiet = !move.isCapture(*board.bbState) && move.flag() != chess::BBMove::EnPassantCapture;
+        
+        bool isKiller = killers && (move.value == killers[0].value || move.value == killers[1].value);
+        
+        // Late quiet moves may be reduced or pruned, unless they escape or
+        // give check, promote, or are killers. Everything is decided before
+        // the move is made, with the check test left until last.
+        bool isLateQuiet = numMovesSearched > 0 && isQuiet && !isKiller && !move.isPromotion() && !inCheck;
+        
+        // Late move pruning drops quiets once enough have been tried at a
+        // shallow depth; futility pruning drops them when even a generous
+        // positional gain would leave the static eval below alpha
+        if (isLateQuiet && canPrune && !isMateScore(alpha)) {
+            bool latePrune = useLateMovePruning && depth <= LATE_MOVE_PRUNING_MAX_DEPTH &&
+                             static_cast<int>(quietsSearched.size()) >= lateMovePruningCount(depth);
+            bool futilityPrune = !latePrune && useFutilityPruning && depth <= FUTILITY_MAX_DEPTH &&
+                                 staticEval + FUTILITY_MARGIN[depth] <= alpha;
+            if (latePrune || futilityPrune) {
+                if (!chess::givesCheck(state, move)) {
+                    if (latePrune) {
+                        numLateMovePrunes++;
+                    } else {
+                        numFutilityPrunes++;
+                    }
+                    continue;
+                }
+                isLateQuiet = false;
+            }
+        }
+        if (isLateQuiet) {
+            isLateQuiet = !chess::givesCheck(state, move);
+        }
+        
+        uint64_t moveHash = 0;
+        if (deferred && !isDeferred && numMovesSearched > 0) {
+            moveHash = AbdadaTable::moveHash(key, move);
+            if (abdadaTable->isSearching(moveHash)) {
+                deferred->push_back(move);
+                continue;
+            }
+            abdadaTable->startSearch(moveHash);
+        }
+        
+        int movingPiece = state.square[move.startSquare()];
+        if (plyFromRoot < MAX_KILLER_PLY) {
+            playedMoves[plyFromRoot] = {movingPiece, move};
+        }
+        chess::UndoState undo = board.executeMove(move, true);
+        
+        // PVS: the first move gets the full window, the rest only have to be
+        // shown no better than it with a null window, and are searched again
+        // in full only when that fails
+        int eval;
+        if (numMovesSearched == 0) {
+            eval = -searchMoves(board, tt, depth - 1, plyFromRoot + 1, -beta, -alpha);
+        } else {
+            // LMR: late quiet moves are unlikely to be best, so they get a
+            // shallower null-window search first and the full depth only if
+            // they beat alpha
+            int reduction = 0;
+            if (useLateMoveReductions && isLateQuiet && depth >= LMR_MIN_DEPTH && numMovesSearched >= LMR_MIN_MOVES) {
+                int moveNumber = std::min(numMovesSearched, MAX_LMR_MOVES - 1);
+                reduction = std::clamp<int>(LMR_TABLE[depth][moveNumber], 0, depth - 2);
+            }
+            
+            eval = -searchMoves(board, tt, depth - 1 - reduction, plyFromRoot + 1, -alpha - 1, -alpha);
+            if (reduction > 0) {
+                numLmrReductions++;
+                if (eval > alpha && !abortSearch) {
+                    numLmrResearches++;
+                    eval = -searchMoves(board, tt, depth - 1, plyFromRoot + 1, -alpha - 1, -alpha);
+                }
+            }
+            if (eval > alpha && eval < beta && !abortSearch) {
+                numPvsResearches++;
+                eval = -searchMoves(board, tt, depth - 1, plyFromRoot + 1, -beta, -alpha);
+            }
+        }
+        board.undoMove(move, undo);
+        numMovesSearched++;
+        
+        if (moveHash) {
+            abdadaTable->finishSearch(moveHash);
+        }
+        
+        // An aborted child returns a meaningless score; keep it out of the
+        // table, which other threads may still be reading
+        if (abortSearch) {
+            return 0;
+        }
         
         if (eval >= beta) {
-            tt.storeEval(depth, plyFromRoot, beta, tt.LOWER_BOUND, moves[i]);
+            tt.storeEval(key, depth, plyFromRoot, beta, tt.LOWER_BOUND, move);
+            if (isQuiet) {
+                if (killers) {
+                    storeKiller(plyFromRoot, move);
+                }
+                int bonus = historyBonus(depth);
+                updateQuietHistories(us, move, movingPiece, continuations, bonus);
+                for (size_t i = 0; i < quietsSearched.size(); ++i) {
+                    chess::BBMove quiet = quietsSearched[i];
+                    updateQuietHistories(us, quiet, state.square[quiet.startSquare()], continuations, -bonus);
+                }
+                if (plyFromRoot > 0 && plyFromRoot <= MAX_KILLER_PLY) {
+                    const PlayedMove& previous = playedMoves[plyFromRoot - 1];
+                    if (previous.piece != chess::PIECE_NONE) {
+                        counterMoves[previous.move.startSquare()][previous.move.targetSquare()] = move;
+                    }
+                }
+            }
             numCutoffs++;
+            int statsDepth = std::min(depth, MAX_SEARCH_DEPTH);
+            numFailHighs[statsDepth]++;
+            if (numMovesSearched == 1) {
+                numFailHighsFirst[statsDepth]++;
+            }
             return beta;
         }
+        if (isQuiet) {
+            quietsSearched.push_back(move);
+        }
         
         if (eval > alpha) {
             evalType = tt.EXACT;
-            bestMoveInThisPosition = moves[i];
+            bestMoveInThisPosition = move;
             alpha = eval;
             
             if (plyFromRoot == 0) {
-                bestMoveThisIteration = moves[i];
+                bestMoveThisIteration = move;
                 bestEvalThisIteration = eval;
             }
         }
     }
     
-    tt.storeEval(depth, plyFromRoot, alpha, evalType, bestMoveInThisPosition);
+    // Checkmate and stalemate detection
+    if (numMovesSearched == 0) {
+        if (picker.inCheck()) {
+            return -(IMMEDIATE_MATE_SCORE - plyFromRoot);
+        }
+        return 0;
+    }
+    
+    tt.storeEval(key, depth, plyFromRoot, alpha, evalType, bestMoveInThisPosition);
     return alpha;
 }
 
@@ -432,15 +791,17 @@ int AI_BB::quiescenceSearch(BoardBB& board, TranspositionTable& tt, int alpha, i
     }
     
     numQNodes++;
+    if (hasLimits && --nodesUntilLimitCheck <= 0) {
+        checkLimits();
+    }
     
     // Only search capture moves to resolve tactical sequences
-    std::vector<chess::BBMove> moves = board.bbGenerator->generateMoves(*board.bbState, true);
-    orderMoves(board, tt, moves);
+    MovePicker picker(*board.bbState, *board.bbGenerator, useMoveOrdering);
     
-    for (size_t i = 0; i < moves.size(); i++) {
-        chess::UndoState undo = board.executeMove(moves[i], true);
+    for (chess::BBMove move = picker.next(); move.value != 0; move = picker.next()) {
+        chess::UndoState undo = board.executeMove(move, true);
         eval = -quiescenceSearch(board, tt, -beta, -alpha, depth + 1);
-        board.undoMove(moves[i], undo);
+        board.undoMove(move, undo);
         
         if (eval >= beta) {
             numCutoffs++;
@@ -454,61 +815,21 @@ int AI_BB::quiescenceSearch(BoardBB& board, TranspositionTable& tt, int alpha, i
     return alpha;
 }
 
-void AI_BB::orderMoves(BoardBB& board, TranspositionTable& tt, std::vector<chess::BBMove>& moves) {
-    if (!useMoveOrdering || moves.empty()) return;
-
-    chess::BBMove hashMove = useTranspositionTable ? tt.getStoredMove() : chess::BBMove();
-    std::vector<int> scores;
-    scores.reserve(moves.size());
-    
-    uint64_t opponentPawnAttackMap = 0;
-    int opponentColourIndex = board.bbState->whiteToMove ? 1 : 0;
-    for (int i = 0; i < board.bbState->pawns[opponentColourIndex].count(); ++i) {
-        int psq = board.bbState->pawns[opponentColourIndex].squares[i];
-        opponentPawnAttackMap |= chess::PrecomputedData::pawnAttackBitboards[psq][opponentColourIndex];
-    }
-    
-    for (const auto& move : moves) {
-        int score = 0;
-        int movingPieceType = board.bbState->getPieceTypeAt(chess::toRow(move.startSquare()), chess::toCol(move.startSquare()));
-        int targetPieceType = board.bbState->getPieceTypeAt(chess::toRow(move.targetSquare()), chess::toCol(move.targetSquare()));
-        
-        // Captures: MVV-LVA
-        if (targetPieceType != chess::PIECE_NONE) {
-            score += CAPTURED_PIECE_VALUE_MULTIPLIER * getPieceValue(targetPieceType) - getPieceValue(movingPieceType);
-        }
-        
-        if (movingPieceType == chess::PIECE_PAWN) {
-            switch (move.flag()) {
-                case chess::BBMove::PromoteToQueen:  score += QUEEN_VALUE; break;
-                case chess::BBMove::PromoteToRook:   score += ROOK_VALUE; break;
-                case chess::BBMove::PromoteToBishop: score += BISHOP_VALUE; break;
-                case chess::BBMove::PromoteToKnight: score += KNIGHT_VALUE; break;
-                default: break;
-            }
-        } else {
-            if (board.bbState->containSquare(opponentPawnAttackMap, move.targetSquare())) {
-                score -= SQUARE_CONTROLLED_BY_OPPONENT_PAWN_PENALTY;
-            }
-        }
-        
-        // Hash move priority
-        if (move.value == hashMove.value) {
-            score += 10000;
+void AI_BB::updateQuietHistories(int colorIdx, chess::BBMove move, int movingPiece,
+                                 PieceToHistory* const continuations[2], int bonus) {
+    history.update(colorIdx, move, bonus);
+    for (int i = 0; i < 2; ++i) {
+        if (continuations[i]) {
+            continuations[i]->update(movingPiece, move.targetSquare(), bonus);
         }
-        
-        scores.push_back(score);
     }
-    
-    // Sort moves by score
-    for (size_t i = 0; i < moves.size() - 1; ++i) {
-        for (size_t j = i + 1; j > 0; --j) {
-            size_t swapIndex = j - 1;
-            if (scores[swapIndex] < scores[j]) {
-                std::swap(moves[j], moves[swapIndex]);
-                std::swap(scores[j], scores[swapIndex]);
-            }
-        }
+}
+
+void AI_BB::storeKiller(int plyFromRoot, const chess::BBMove& move) {
+    chess::BBMove* killers = killerMoves[plyFromRoot];
+    if (killers[0].value != move.value) {
+        killers[1] = killers[0];
+        killers[0] = move;
     }
 }
 
@@ -517,6 +838,20 @@ bool AI_BB::isMateScore(int score) const {
     return std::abs(score) > IMMEDIATE_MATE_SCORE - maxMateDepth;
 }
 
+// Called every LIMIT_CHECK_INTERVAL nodes, so reading the clock stays off
+// the per-node path
+void AI_BB::checkLimits() {
+    uint64_t nodes = static_cast<uint64_t>(numNodes) + static_cast<uint64_t>(numQNodes);
+    if (timeManager.hardLimitReached() || (nodeLimit > 0 && nodes >= nodeLimit)) {
+        abortSearch = true;
+    }
+    
+    nodesUntilLimitCheck = LIMIT_CHECK_INTERVAL;
+    if (nodeLimit > 0 && nodes < nodeLimit) {
+        nodesUntilLimitCheck = static_cast<int>(std::min<uint64_t>(nodeLimit - nodes, LIMIT_CHECK_INTERVAL));
+    }
+}
+
 void AI_BB::endSearch() {
     abortSearch = true;
 }
@@ -528,13 +863,14 @@ void AI_BB::setThreadCount(unsigned int numThreads) {
         threadPool->shutdown();
         threadPool.reset();
     }
+    helpers.clear();
     
     threadCount = (numThreads == 0) ? std::thread::hardware_concurrency() : numThreads;
     if (threadCount == 0) threadCount = 1;
     
     if (threadCount > 1) {
         try {
-            threadPool = std::make_unique<ThreadPool>(threadCount);
+            threadPool = std::make_unique<ThreadPool>(threadCount - 1);
         } catch (const std::exception& e) {
             std::cerr << "Failed to create thread pool: " << e.what() << std::endl;
             threadPool = nullptr;
@@ -0,0 +1,215 @@
+#include <chess/AI/move_picker.h>
+#include <chess/AI/ai_bb.h>
+#include <chess/board/bitboard/precomputed_data.h>
+#include <chess/board/bitboard/see.h>
+#include <chess/board/bitboard/bitboard.h>
+#include <chess/board/pieces/piece_const.h>
+#include <utility>
+
+namespace {
+
+int pieceValue(int pieceType) {
+    switch (pieceType) {
+        case chess::PIECE_PAWN:   return PAWN_VALUE;
+        case chess::PIECE_KNIGHT: return KNIGHT_VALUE;
+        case chess::PIECE_BISHOP: return BISHOP_VALUE;
+        case chess::PIECE_ROOK:   return ROOK_VALUE;
+        case chess::PIECE_QUEEN:  return QUEEN_VALUE;
+        default:                  return 0;
+    }
+}
+
+int promotionValue(chess::BBMove::Flag flag) {
+    switch (flag) {
+        case chess::BBMove::PromoteToQueen:  return QUEEN_VALUE;
+        case chess::BBMove::PromoteToRook:   return ROOK_VALUE;
+        case chess::BBMove::PromoteToBishop: return BISHOP_VALUE;
+        case chess::BBMove::PromoteToKnight: return KNIGHT_VALUE;
+        default:                             return 0;
+    }
+}
+
+} // namespace
+
+MovePicker::MovePicker(chess::BitboardState& state, chess::MoveGeneratorBB& generator,
+                       chess::BBMove ttMove, const chess::BBMove* killers, chess::BBMove counterMove,
+                       const QuietHistory& quietHistory, bool orderMoves)
+    : state(state), generator(generator), ttMove(ttMove), counterMove(counterMove), quietHistory(quietHistory),
+      capturesOnly(false),
+      orderMoves(orderMoves), stage(STAGE_TT_MOVE) {
+    for (int i = 0; i < NUM_KILLERS; ++i) {
+        this->killers[i] = killers ? killers[i] : chess::BBMove();
+    }
+}
+
+MovePicker::MovePicker(chess::BitboardState& state, chess::MoveGeneratorBB& generator, bool orderMoves)
+    : state(state), generator(generator), ttMove(), capturesOnly(true),
+      orderMoves(orderMoves), stage(STAGE_GEN_CAPTURES) {}
+
+chess::BBMove MovePicker::next() {
+    switch (stage) {
+        case STAGE_TT_MOVE:
+            stage = STAGE_GEN_CAPTURES;
+            if (chess::isLegal(state, ttMove)) {
+                return ttMove;
+            }
+            [[fallthrough]];
+
+        case STAGE_GEN_CAPTURES:
+            generator.generateMoves(state, moves, chess::MoveGeneratorBB::GenType::Captures);
+            sideInCheck = generator.getInCheck();
+            scoreCaptures();
+            current = 0;
+            stage = STAGE_CAPTURES;
+            [[fallthrough]];
+
+        case STAGE_CAPTURES:
+            // Captures that lose material are held back until after the
+            // quiets, and dropped entirely in quiescence search
+            while (current < moves.size()) {
+                chess::BBMove move = pickBest();
+                if (move.value == ttMove.value) {
+                    continue;
+                }
+                if (!chess::seeGE(state, move, 0)) {
+                    badCaptures.push_back(move);
+                    continue;
+                }
+                return move;
+            }
+            if (capturesOnly) {
+                stage = STAGE_DONE;
+                return chess::BBMove();
+            }
+            stage = STAGE_KILLERS;
+            [[fallthrough]];
+
+        case STAGE_KILLERS:
+            // Killers come from sibling nodes, so each one is validated here;
+            // a cutoff on a killer never generates the quiets
+            while (killerIndex < NUM_KILLERS) {
+                chess::BBMove& killer = killers[killerIndex++];
+                if (killer.value != ttMove.value && isQuiet(killer) && chess::isLegal(state, killer)) {
+                    return killer;
+                }
+                killer = chess::BBMove();
+            }
+            stage = STAGE_COUNTER_MOVE;
+            [[fallthrough]];
+
+        case STAGE_COUNTER_MOVE:
+            stage = STAGE_GEN_QUIETS;
+            if (counterMove.value != ttMove.value && counterMove.value != killers[0].value &&
+                counterMove.value != killers[1].value && isQuiet(counterMove) &&
+                chess::isLegal(state, counterMove)) {
+                return counterMove;
+            }
+            counterMove = chess::BBMove();
+            [[fallthrough]];
+
+        case STAGE_GEN_QUIETS:
+            generator.generateMoves(state, moves, chess::MoveGeneratorBB::GenType::Quiets);
+            scoreQuiets();
+            current = 0;
+            stage = STAGE_QUIETS;
+            [[fallthrough]];
+
+        case STAGE_QUIETS:
+            // Killers and counter move still set here were already played
+            while (current < moves.size()) {
+                chess::BBMove move = pickBest();
+                if (move.value != ttMove.value && move.value != killers[0].value &&
+                    move.value != killers[1].value && move.value != counterMove.value) {
+                    return move;
+                }
+            }
+            current = 0;
+            stage = STAGE_BAD_CAPTURES;
+            [[fallthrough]];
+
+        case STAGE_BAD_CAPTURES:
+            if (current < badCaptures.size()) {
+                return badCaptures[current++];
+            }
+            stage = STAGE_DONE;
+            [[fallthrough]];
+
+        default:
+            return chess::BBMove();
+    }
+}
+
+bool MovePicker::isQuiet(const chess::BBMove& move) const {
+    // Same split as GenType::Quiets
+    return state.square[move.targetSquare()] == chess::PIECE_NONE &&
+           move.flag() != chess::BBMove::EnPassantCapture;
+}
+
+void MovePicker::scoreCaptures() {
+    if (!orderMoves) return;
+
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const chess::BBMove& move = moves[i];
+        int movingPieceType = chess::typeOf(state.square[move.startSquare()]);
+        int capturedPieceType = move.flag() == chess::BBMove::EnPassantCapture
+                                    ? chess::PIECE_PAWN
+                                    : chess::typeOf(state.square[move.targetSquare()]);
+
+        // MVV-LVA
+        scores[i] = CAPTURED_PIECE_VALUE_MULTIPLIER * pieceValue(capturedPieceType) - pieceValue(movingPieceType) +
+                    promotionValue(move.flag());
+    }
+}
+
+void MovePicker::scoreQuiets() {
+    if (!orderMoves) return;
+
+    uint64_t opponentPawnAttackMap = 0;
+    int opponentColourIndex = state.whiteToMove ? 1 : 0;
+    int colourIndex = opponentColourIndex ^ 1;
+    uint64_t opponentPawns = state.pieces(opponentColourIndex, chess::PIECE_PAWN);
+    while (opponentPawns) {
+        int psq = chess::popLSB(opponentPawns);
+        opponentPawnAttackMap |= chess::PrecomputedData::pawnAttackBitboards[psq][opponentColourIndex];
+    }
+
+    for (size_t i = 0; i < moves.size(); ++i) {
+        const chess::BBMove& move = moves[i];
+        int movingPiece = state.square[move.startSquare()];
+        int movingPieceType = chess::typeOf(movingPiece);
+        int score = 0;
+
+        if (quietHistory.butterfly) {
+            score += quietHistory.butterfly->get(colourIndex, move);
+        }
+        for (const PieceToHistory* continuation : quietHistory.continuations) {
+            if (continuation) {
+                score += continuation->get(movingPiece, move.targetSquare());
+            }
+        }
+
+        if (movingPieceType == chess::PIECE_PAWN) {
+            score += promotionValue(move.flag());
+        } else if (chess::getBit(opponentPawnAttackMap, move.targetSquare())) {
+            score -= SQUARE_CONTROLLED_BY_OPPONENT_PAWN_PENALTY;
+        }
+
+        scores[i] = score;
+    }
+}
+
+chess::BBMove MovePicker::pickBest() {
+    // Selection rather than a full sort: cut nodes rarely look past the
+    // first few moves of a stage
+    if (orderMoves) {
+        size_t best = current;
+        for (size_t i = current + 1; i < moves.size(); ++i) {
+            if (scores[i] > scores[best]) {
+                best = i;
+            }
+        }
+        std::swap(moves[best], moves[current]);
+        std::swap(scores[best], scores[current]);
+    }
+    return moves[current++];
+}
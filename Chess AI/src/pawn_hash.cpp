@@ -0,0 +1,125 @@
+#include <chess/AI/pawn_hash.h>
+#include <chess/board/bitboard/bitboard.h>
+#include <chess/board/bitboard/precomputed_data.h>
+#include <chess/board/pieces/piece_const.h>
+#include <algorithm>
+
+namespace {
+
+using chess::Score;
+using chess::makeScore;
+
+constexpr Score DOUBLED_PAWN_PENALTY = makeScore(-10, -25);
+constexpr Score ISOLATED_PAWN_PENALTY = makeScore(-10, -15);
+constexpr Score BACKWARD_PAWN_PENALTY = makeScore(-8, -12);
+
+// By rank counted from the pawn's own side
+constexpr Score PASSED_PAWN_BONUS[8] = {
+    makeScore(0, 0), makeScore(5, 10), makeScore(10, 15), makeScore(15, 25),
+    makeScore(30, 45), makeScore(50, 75), makeScore(80, 120), makeScore(0, 0)
+};
+
+struct PawnMasks {
+    // [file]
+    uint64_t adjacentFiles[8]{};
+    // [colorIndex][square]: the square's file ahead of it
+    uint64_t forwardFile[2][64]{};
+    // [colorIndex][square]: the square's and adjacent files ahead of it
+    uint64_t passedSpan[2][64]{};
+    // [colorIndex][square]: adjacent files level with or behind the square
+    uint64_t supportSpan[2][64]{};
+};
+
+constexpr PawnMasks buildPawnMasks() {
+    PawnMasks masks{};
+    for (int file = 0; file < 8; ++file) {
+        if (file > 0) masks.adjacentFiles[file] |= chess::FILE_A << (file - 1);
+        if (file < 7) masks.adjacentFiles[file] |= chess::FILE_A << (file + 1);
+    }
+    for (int square = 0; square < 64; ++square) {
+        int rank = square / 8;
+        int file = square % 8;
+        uint64_t fileMask = chess::FILE_A << file;
+        uint64_t ranksAbove = rank == 7 ? 0ULL : ~0ULL << (8 * (rank + 1));
+        uint64_t ranksBelow = (1ULL << (8 * rank)) - 1;
+        uint64_t ranksAhead[2] = {ranksAbove, ranksBelow};
+        for (int color = 0; color < 2; ++color) {
+            masks.forwardFile[color][square] = ranksAhead[color] & fileMask;
+            masks.passedSpan[color][square] = ranksAhead[color] & (fileMask | masks.adjacentFiles[file]);
+            masks.supportSpan[color][square] = ~ranksAhead[color] & masks.adjacentFiles[file];
+        }
+    }
+    return masks;
+}
+
+constexpr PawnMasks PAWN_MASKS = buildPawnMasks();
+
+Score evaluateSide(const chess::BitboardState& state, int colorIdx, uint64_t& passed) {
+    uint64_t ours = state.pieces(colorIdx, chess::PIECE_PAWN);
+    uint64_t theirs = state.pieces(colorIdx ^ 1, chess::PIECE_PAWN);
+    Score score = 0;
+    passed = 0;
+
+    uint64_t pawns = ours;
+    while (pawns) {
+        int sq = chess::popLSB(pawns);
+        int relativeRank = colorIdx == 0 ? sq / 8 : 7 - sq / 8;
+        bool frontBlockedByOwnPawn = PAWN_MASKS.forwardFile[colorIdx][sq] & ours;
+
+        // Only the rear pawn of a doubled pair is penalised
+        if (frontBlockedByOwnPawn) {
+            score += DOUBLED_PAWN_PENALTY;
+        }
+
+        if (!(PAWN_MASKS.adjacentFiles[sq % 8] & ours)) {
+            score += ISOLATED_PAWN_PENALTY;
+        } else if (!(PAWN_MASKS.supportSpan[colorIdx][sq] & ours)) {
+            // No neighbour can come up to support it and an enemy pawn
+            // holds the square in front
+            int stopSquare = colorIdx == 0 ? sq + 8 : sq - 8;
+            if (chess::PrecomputedData::pawnAttackBitboards[stopSquare][colorIdx] & theirs) {
+                score += BACKWARD_PAWN_PENALTY;
+            }
+        }
+
+        if (!frontBlockedByOwnPawn && !(PAWN_MASKS.passedSpan[colorIdx][sq] & theirs)) {
+            passed |= 1ULL << sq;
+            score += PASSED_PAWN_BONUS[relativeRank];
+        }
+    }
+    return score;
+}
+
+} // namespace
+
+void evaluatePawns(const chess::BitboardState& state, PawnEntry& entry) {
+    entry.key = state.pawnKey;
+    entry.score = evaluateSide(state, 0, entry.passedPawns[0]) - evaluateSide(state, 1, entry.passedPawns[1]);
+}
+
+PawnHashTable::PawnHashTable(size_t numEntries) {
+    size_t powerOf2 = 1;
+    while (powerOf2 < numEntries) {
+        powerOf2 *= 2;
+    }
+    table.resize(powerOf2);
+}
+
+const PawnEntry& PawnHashTable::probe(const chess::BitboardState& state) {
+    PawnEntry& entry = table[state.pawnKey & (table.size() - 1)];
+    numProbes++;
+    // A zero key (no pawns) also matches an untouched entry, whose score of
+    // zero is the right answer
+    if (entry.key == state.pawnKey) {
+        numHits++;
+        return entry;
+    }
+    evaluatePawns(state, entry);
+    return entry;
+}
+
+void PawnHashTable::clear() {
+    std::fill(table.begin(), table.end(), PawnEntry());
+    numProbes = 0;
+    numHits = 0;
+}
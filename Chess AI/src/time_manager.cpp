@@ -0,0 +1,45 @@
+#include <chess/AI/time_manager.h>
+#include <algorithm>
+
+void TimeManager::start(const SearchLimits& limits, bool whiteToMove) {
+    startTime = Clock::now();
+    instability = 0.0;
+    timed = limits.moveTimeMs > 0 || limits.usesClock();
+
+    if (limits.moveTimeMs > 0) {
+        // A fixed move time is used in full, so both deadlines are the same
+        softLimitMs = hardLimitMs = baseSoftLimitMs = limits.moveTimeMs;
+        return;
+    }
+    if (!timed) {
+        softLimitMs = hardLimitMs = baseSoftLimitMs = 0;
+        return;
+    }
+
+    int64_t timeLeft = whiteToMove ? limits.whiteTimeMs : limits.blackTimeMs;
+    int64_t increment = whiteToMove ? limits.whiteIncrementMs : limits.blackIncrementMs;
+    int movesToGo = limits.movesToGo > 0 ? limits.movesToGo : DEFAULT_MOVES_TO_GO;
+
+    int64_t available = std::max<int64_t>(timeLeft - MOVE_OVERHEAD_MS, 1);
+    int64_t soft = available / movesToGo + increment * 3 / 4;
+
+    // Never plan to spend more than three quarters of what is left on one
+    // move, even when the increment would cover it
+    hardLimitMs = std::min(soft * HARD_LIMIT_FACTOR, available * 3 / 4);
+    hardLimitMs = std::max<int64_t>(hardLimitMs, 1);
+    softLimitMs = baseSoftLimitMs = std::min(soft, hardLimitMs);
+}
+
+void TimeManager::updateStability(bool bestMoveChanged) {
+    if (!timed) return;
+
+    // Each change counts half as much one iteration later; repeated changes
+    // can at most double the soft limit
+    instability = instability * 0.5 + (bestMoveChanged ? 1.0 : 0.0);
+    double scale = 1.0 + instability / 2.0;
+    softLimitMs = std::min(static_cast<int64_t>(baseSoftLimitMs * scale), hardLimitMs);
+}
+
+int64_t TimeManager::elapsedMs() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - startTime).count();
+}
@@ -4,11 +4,13 @@
 #include <chrono>
 #include <cstdint>
 #include <algorithm>
+#include <bitset>
 #include <future>
 #include <mutex>
 
 #include <chess/board/bitboard/board_state.h>
 #include <chess/board/bitboard/move_generator_bb.h>
+#include <chess/board/bitboard/move_list.h>
 #include <chess/board/bitboard/move_exec.h>
 #include <chess/utils/thread_pool.h>
 
@@ -16,6 +18,7 @@ using namespace chess;
 using Clock = std::chrono::high_resolution_clock;
 
 static bool g_enableBulkCount = true;
+static bool g_copyMake = false;
 static std::string onlyMoveGlobal = "";
 
 static std::string moveToString(const BBMove& mv) {
@@ -43,7 +46,8 @@ static std::string moveToString(const BBMove& mv) {
 
 static std::uint64_t perftRecursive(BitboardState& state, MoveGeneratorBB& gen, BBMoveExecutor& exec, int depth) {
     if (depth == 0) return 1ULL;
-    std::vector<BBMove> moves = gen.generateMoves(state, false);
+    MoveList moves;
+    gen.generateMoves(state, moves, false);
     if (depth == 1) return static_cast<std::uint64_t>(moves.size());
     std::uint64_t nodes = 0ULL;
     for (const auto& mv : moves) {
@@ -54,8 +58,26 @@ static std::uint64_t perftRecursive(BitboardState& state, MoveGeneratorBB& gen,
     return nodes;
 }
 
+// Copy-make: each child is a copy of its parent, so nothing is ever undone
+static std::uint64_t perftCopyMake(BitboardState& state, MoveGeneratorBB& gen, int depth) {
+    if (depth == 0) return 1ULL;
+    MoveList moves;
+    gen.generateMoves(state, moves, false);
+    if (depth == 1) return static_cast<std::uint64_t>(moves.size());
+    std::uint64_t nodes = 0ULL;
+    for (const auto& mv : moves) {
+        BitboardState child = state;
+        BBMoveExecutor(child).makeMove(mv);
+        nodes += perftCopyMake(child, gen, depth - 1);
+    }
+    return nodes;
+}
+
 static std::uint64_t perft(BitboardState& state, int depth) {
     MoveGeneratorBB gen;
+    if (g_copyMake) {
+        return perftCopyMake(state, gen, depth);
+    }
     BBMoveExecutor exec(state);
     return perftRecursive(state, gen, exec, depth);
 }
@@ -63,7 +85,8 @@ static std::uint64_t perft(BitboardState& state, int depth) {
 static std::uint64_t perftSplit(BitboardState& state, int depth) {
     MoveGeneratorBB gen;
     BBMoveExecutor exec(state);
-    std::vector<BBMove> moves = gen.generateMoves(state, false);
+    MoveList moves;
+    gen.generateMoves(state, moves, false);
     std::uint64_t total = 0ULL;
     
     for (const auto& mv : moves) {
@@ -98,28 +121,16 @@ static std::uint64_t perftSplitMT(const BitboardState& rootState, int depth, int
     
     for (const auto& mv : filteredMoves) {
         futures.emplace_back(pool.enqueue([&rootState, mv, depth, &coutMutex]() -> std::uint64_t {
+            // Each task gets its own copy of the root, which is a plain memcpy
             BitboardState freshState = rootState;
-            MoveGeneratorBB gen;
-            BBMoveExecutor exec(freshState);
+            BBMoveExecutor(freshState).makeMove(mv);
+            std::uint64_t moveNodes = perft(freshState, depth - 1);
             
-            // Find and execute the move
-            std::vector<BBMove> freshMoves = gen.generateMoves(freshState, false);
-            for (const auto& fm : freshMoves) {
-                if (fm.startSquare() == mv.startSquare() && 
-                    fm.targetSquare() == mv.targetSquare() &&
-                    fm.flag() == mv.flag()) {
-                    UndoState u = exec.makeMove(fm);
-                    std::uint64_t moveNodes = perft(freshState, depth - 1);
-                    exec.unmakeMove(fm, u);
-                    
-                    {
-                        std::lock_guard<std::mutex> lk(coutMutex);
-                        std::cout << moveToString(fm) << ": " << moveNodes << std::endl;
-                    }
-                    return moveNodes;
-                }
+            {
+                std::lock_guard<std::mutex> lk(coutMutex);
+                std::cout << moveToString(mv) << ": " << moveNodes << std::endl;
             }
-            return 0ULL;
+            return moveNodes;
         }));
     }
     
@@ -159,22 +170,8 @@ static std::uint64_t perftMT(const BitboardState& rootState, int depth, int maxT
     for (const auto& mv : filteredMoves) {
         futures.emplace_back(pool.enqueue([&rootState, mv, depth]() -> std::uint64_t {
             BitboardState freshState = rootState;
-            MoveGeneratorBB gen;
-            BBMoveExecutor exec(freshState);
-            
-            // Find and execute the move
-            std::vector<BBMove> freshMoves = gen.generateMoves(freshState, false);
-            for (const auto& fm : freshMoves) {
-                if (fm.startSquare() == mv.startSquare() && 
-                    fm.targetSquare() == mv.targetSquare() &&
-                    fm.flag() == mv.flag()) {
-                    UndoState u = exec.makeMove(fm);
-                    std::uint64_t moveNodes = perft(freshState, depth - 1);
-                    exec.unmakeMove(fm, u);
-                    return moveNodes;
-                }
-            }
-            return 0ULL;
+            BBMoveExecutor(freshState).makeMove(mv);
+            return perft(freshState, depth - 1);
         }));
     }
     
@@ -185,6 +182,120 @@ static std::uint64_t perftMT(const BitboardState& rootState, int depth, int maxT
     return totalNodes;
 }
 
+static const char* backendName(SliderBackend backend) {
+    return backend == SliderBackend::Pext ? "pext" : "magic";
+}
+
+// Runs the same perft for every supported slider backend, with both
+// make/unmake and copy-make
+static void perftBench(const BitboardState& rootState, int depth) {
+    const SliderBackend originalBackend = MoveGeneratorBB::getSliderBackend();
+    const bool originalCopyMake = g_copyMake;
+    std::uint64_t expected = 0ULL;
+    
+    std::cout << "Default backend: " << backendName(originalBackend)
+              << "  State size: " << sizeof(BitboardState) << " bytes" << std::endl;
+    for (SliderBackend backend : {SliderBackend::Magic, SliderBackend::Pext}) {
+        if (!MoveGeneratorBB::setSliderBackend(backend)) {
+            std::cout << backendName(backend) << ": not supported on this CPU" << std::endl;
+            continue;
+        }
+        
+        for (bool copyMake : {false, true}) {
+            g_copyMake = copyMake;
+            BitboardState s = rootState;
+            auto t0 = Clock::now();
+            std::uint64_t nodes = perft(s, depth);
+            auto t1 = Clock::now();
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+            double mnps = ms > 0 ? static_cast<double>(nodes) / (ms * 1000.0) : 0.0;
+            
+            std::cout << backendName(backend) << (copyMake ? " copy-make:   " : " make/unmake: ") << nodes
+                      << " positions  Time: " << ms << " milliseconds  " << mnps << " Mnps";
+            if (expected != 0ULL && nodes != expected) {
+                std::cout << "  MISMATCH (expected " << expected << ")";
+            }
+            std::cout << std::endl;
+            expected = nodes;
+        }
+    }
+    
+    MoveGeneratorBB::setSliderBackend(originalBackend);
+    g_copyMake = originalCopyMake;
+}
+
+// Standard perft positions, used by validate when no FEN is given
+static const char* const VALIDATION_FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+// At every node of the perft tree, checks all 65536 move encodings:
+// isLegal must agree with the generated list, and every generated move
+// must be pseudo-legal. Returns the number of positions checked.
+static std::uint64_t validateTree(BitboardState& state, MoveGeneratorBB& gen, BBMoveExecutor& exec,
+                                  int depth, std::uint64_t& mismatches) {
+    MoveList moves;
+    gen.generateMoves(state, moves, false);
+    std::bitset<65536> generated;
+    for (const auto& mv : moves) {
+        generated.set(mv.value);
+    }
+    
+    for (int value = 0; value < 65536; ++value) {
+        BBMove mv(static_cast<uint16_t>(value));
+        bool legal = isLegal(state, mv);
+        bool pseudoLegal = isPseudoLegal(state, mv);
+        if (legal == generated[value] && (pseudoLegal || !legal)) {
+            continue;
+        }
+        if (++mismatches <= 10) {
+            std::cout << "MISMATCH " << state.toFEN() << "  move " << moveToString(mv)
+                      << " flag " << mv.flag() << "  generated " << generated[value]
+                      << " legal " << legal << " pseudo-legal " << pseudoLegal << std::endl;
+        }
+    }
+    
+    std::uint64_t positions = 1ULL;
+    if (depth > 1) {
+        for (const auto& mv : moves) {
+            UndoState u = exec.makeMove(mv);
+            positions += validateTree(state, gen, exec, depth - 1, mismatches);
+            exec.unmakeMove(mv, u);
+        }
+    }
+    return positions;
+}
+
+static bool validateMoves(const std::vector<std::string>& fens, int depth) {
+    MoveGeneratorBB gen;
+    std::uint64_t mismatches = 0ULL;
+    
+    for (const auto& fen : fens) {
+        BitboardState state;
+        state.clear();
+        state.loadFromFEN(fen);
+        BBMoveExecutor exec(state);
+        
+        auto t0 = Clock::now();
+        std::uint64_t positions = validateTree(state, gen, exec, depth, mismatches);
+        auto t1 = Clock::now();
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+        std::cout << positions << " positions x 65536 encodings  Time: " << ms << " milliseconds  " << fen << std::endl;
+    }
+    
+    if (mismatches == 0) {
+        std::cout << "Move validation OK" << std::endl;
+    } else {
+        std::cout << "Move validation FAILED: " << mismatches << " mismatches" << std::endl;
+    }
+    return mismatches == 0;
+}
+
 static bool isNumber(const std::string& s) {
     return !s.empty() && std::all_of(s.begin(), s.end(), ::isdigit);
 }
@@ -192,6 +303,9 @@ static bool isNumber(const std::string& s) {
 int main(int argc, char* argv[]) {
     int maxDepth = 4;
     bool splitMode = false;
+    bool benchMode = false;
+    bool validateMode = false;
+    bool fenGiven = false;
     int maxThreads = 0; // 0 = use all available
     std::string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
 
@@ -204,6 +318,21 @@ int main(int argc, char* argv[]) {
                 maxDepth = std::max(1, std::atoi(argv[i + 1]));
                 ++i;
             }
+        } else if (arg == "bench") {
+            benchMode = true;
+            if (i + 1 < argc && isNumber(argv[i + 1])) {
+                maxDepth = std::max(1, std::atoi(argv[i + 1]));
+                ++i;
+            }
+        } else if (arg == "validate") {
+            validateMode = true;
+            maxDepth = 2;
+            if (i + 1 < argc && isNumber(argv[i + 1])) {
+                maxDepth = std::max(1, std::atoi(argv[i + 1]));
+                ++i;
+            }
+        } else if (arg == "--copy-make") {
+            g_copyMake = true;
         } else if (arg == "--threads" || arg == "-t") {
             if (i + 1 < argc && isNumber(argv[i + 1])) {
                 maxThreads = std::max(1, std::atoi(argv[i + 1]));
@@ -218,6 +347,7 @@ int main(int argc, char* argv[]) {
             maxDepth = std::max(1, std::atoi(arg.c_str()));
         } else if (arg.rfind("--", 0) != 0) {
             fen = arg;
+            fenGiven = true;
             while (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
                 fen += " ";
                 fen += argv[++i];
@@ -225,6 +355,14 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (validateMode) {
+        std::vector<std::string> fens(std::begin(VALIDATION_FENS), std::end(VALIDATION_FENS));
+        if (fenGiven) {
+            fens.assign(1, fen);
+        }
+        return validateMoves(fens, maxDepth) ? 0 : 1;
+    }
+
     BitboardState state;
     state.clear();
     state.loadFromFEN(fen);
@@ -236,9 +374,14 @@ int main(int argc, char* argv[]) {
     if (!onlyMoveGlobal.empty()) {
         std::cout << "Filtering for move: " << onlyMoveGlobal << std::endl;
     }
+    if (g_copyMake) {
+        std::cout << "Using copy-make" << std::endl;
+    }
     std::cout << std::endl;
 
-    if (splitMode) {
+    if (benchMode) {
+        perftBench(state, maxDepth);
+    } else if (splitMode) {
         auto t0 = Clock::now();
         std::uint64_t nodes;
         if (maxThreads > 0) {
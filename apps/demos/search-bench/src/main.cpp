@@ -0,0 +1,221 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+
+#include <chess/board/boardBB.h>
+#include <chess/AI/ai_bb.h>
+#include <chess/utils/logger.h>
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Middlegame and endgame positions of the usual perft and search test sets
+static const char* BENCH_FENS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "2r3k1/pp3ppp/2n5/3q4/3P4/2PB1N2/P4PPP/R2Q2K1 b - - 0 1",
+    "r1bq1rk1/pp2bppp/2n2n2/3p4/3P4/2NB1N2/PP3PPP/R1BQ1RK1 w - - 0 10",
+};
+
+struct BenchResult {
+    long long ms = 0;
+    uint64_t nodes = 0;
+    std::vector<uint16_t> bestMoves;
+};
+
+static BenchResult runBench(ParallelScheduler scheduler, unsigned threads, int depth) {
+    AI_BB ai(threads);
+    Settings settings;
+    settings.parallelScheduler = scheduler;
+    ai.updateSettings(settings);
+
+    BenchResult result;
+    for (const char* fen : BENCH_FENS) {
+        BoardBB board(100, 100, 30.0f);
+        board.loadFEN(fen, nullptr);
+        // Unrelated positions: nothing to carry over from the previous one
+        ai.newGame();
+
+        auto t0 = Clock::now();
+        chess::BBMove move = ai.getSearchResultParallel(board, depth).first;
+        auto t1 = Clock::now();
+
+        result.ms += std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+        result.nodes += static_cast<uint64_t>(ai.getNumNodes()) + static_cast<uint64_t>(ai.getNumQNodes());
+        result.nodes += ai.getNumHelperNodes();
+        result.bestMoves.push_back(move.value);
+    }
+    return result;
+}
+
+// Share of beta cutoffs produced by the first move searched, per remaining
+// depth, summed over the positions; single-threaded so the counts are exact
+static void runOrderingReport(int depth) {
+    std::vector<uint64_t> failHighs(depth + 1, 0);
+    std::vector<uint64_t> failHighsFirst(depth + 1, 0);
+
+    AI_BB ai(1);
+    for (const char* fen : BENCH_FENS) {
+        BoardBB board(100, 100, 30.0f);
+        board.loadFEN(fen, nullptr);
+        ai.newGame();
+        ai.getSearchResult(board, depth);
+
+        for (int d = 1; d <= depth; ++d) {
+            failHighs[d] += ai.getNumFailHighs(d);
+            failHighsFirst[d] += ai.getNumFailHighsFirst(d);
+        }
+    }
+
+    std::cout << std::setw(6) << "depth" << std::setw(12) << "fail highs" << std::setw(10) << "first" << std::endl;
+    for (int d = 1; d <= depth; ++d) {
+        double first = failHighs[d] > 0 ? 100.0 * failHighsFirst[d] / failHighs[d] : 0.0;
+        std::cout << std::setw(6) << d << std::setw(12) << failHighs[d]
+                  << std::setw(9) << std::fixed << std::setprecision(1) << first << "%" << std::endl;
+    }
+}
+
+struct PruningRun {
+    uint64_t nodes = 0;
+    int fires[4] = {};
+};
+
+static PruningRun runPruningSearch(const char* fen, int depth, const Settings& settings) {
+    AI_BB ai(1);
+    ai.updateSettings(settings);
+    BoardBB board(100, 100, 30.0f);
+    board.loadFEN(fen, nullptr);
+    ai.getSearchResult(board, depth);
+
+    PruningRun run;
+    run.nodes = static_cast<uint64_t>(ai.getNumNodes()) + static_cast<uint64_t>(ai.getNumQNodes());
+    run.fires[0] = ai.getNumReverseFutilityPrunes();
+    run.fires[1] = ai.getNumRazorPrunes();
+    run.fires[2] = ai.getNumFutilityPrunes();
+    run.fires[3] = ai.getNumLateMovePrunes();
+    return run;
+}
+
+// Per position: how often each forward-pruning heuristic fires with all of
+// them on, and how many more nodes the search takes with just that one off
+static void runPruningReport(int depth) {
+    static const char* NAMES[4] = {"rfp", "razor", "futility", "lmp"};
+    bool Settings::*toggles[4] = {&Settings::useReverseFutilityPruning, &Settings::useRazoring,
+                                  &Settings::useFutilityPruning, &Settings::useLateMovePruning};
+
+    std::cout << std::setw(4) << "pos" << std::setw(10) << "nodes";
+    for (const char* name : NAMES) {
+        std::cout << std::setw(10) << name << std::setw(10) << "saved";
+    }
+    std::cout << std::endl;
+
+    for (size_t i = 0; i < std::size(BENCH_FENS); ++i) {
+        PruningRun all = runPruningSearch(BENCH_FENS[i], depth, Settings());
+        std::cout << std::setw(4) << i + 1 << std::setw(10) << all.nodes;
+
+        for (int h = 0; h < 4; ++h) {
+            Settings settings;
+            settings.*toggles[h] = false;
+            PruningRun without = runPruningSearch(BENCH_FENS[i], depth, settings);
+            long long saved = static_cast<long long>(without.nodes) - static_cast<long long>(all.nodes);
+            std::cout << std::setw(10) << all.fires[h] << std::setw(10) << saved;
+        }
+        std::cout << std::endl;
+    }
+}
+
+static std::vector<unsigned> parseThreadList(const std::string& list) {
+    std::vector<unsigned> threads;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int n = std::atoi(item.c_str());
+        if (n > 0) threads.push_back(static_cast<unsigned>(n));
+    }
+    return threads;
+}
+
+// Time to depth and search overhead of the parallel schedulers against the
+// single-thread search, over a fixed set of positions; with --ordering, the
+// fail-high-on-first-move rate per depth instead, and with --pruning the
+// forward-pruning statistics per position.
+// usage: search_bench [depth] [--scheduler lazy|abdada|both] [--threads 1,2,4,8,16]
+//                     [--ordering | --pruning]
+int main(int argc, char* argv[]) {
+    int depth = 7;
+    std::vector<unsigned> threadCounts = {1, 2, 4, 8, 16};
+    std::vector<ParallelScheduler> schedulers = {ParallelScheduler::LazySMP, ParallelScheduler::ABDADA};
+    bool orderingReport = false;
+    bool pruningReport = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threadCounts = parseThreadList(argv[++i]);
+        } else if (arg == "--scheduler" && i + 1 < argc) {
+            std::string name = argv[++i];
+            if (name == "lazy") {
+                schedulers = {ParallelScheduler::LazySMP};
+            } else if (name == "abdada") {
+                schedulers = {ParallelScheduler::ABDADA};
+            }
+        } else if (arg == "--ordering") {
+            orderingReport = true;
+        } else if (arg == "--pruning") {
+            pruningReport = true;
+        } else if (std::atoi(arg.c_str()) > 0) {
+            depth = std::atoi(arg.c_str());
+        }
+    }
+
+    // The per-depth statistics stop at the deepest search the AI allows
+    depth = std::min(depth, MAX_SEARCH_DEPTH);
+
+    Logger::setSilent(true);
+
+    std::cout << "Depth " << depth << ", " << std::size(BENCH_FENS) << " positions" << std::endl;
+    if (orderingReport) {
+        runOrderingReport(depth);
+        return 0;
+    }
+    if (pruningReport) {
+        runPruningReport(depth);
+        return 0;
+    }
+
+    BenchResult single = runBench(ParallelScheduler::LazySMP, 1, depth);
+    std::cout << "1 thread: " << single.ms << " ms, " << single.nodes << " nodes\n" << std::endl;
+
+    for (ParallelScheduler scheduler : schedulers) {
+        std::cout << (scheduler == ParallelScheduler::ABDADA ? "ABDADA" : "Lazy SMP") << std::endl;
+        std::cout << std::setw(8) << "threads" << std::setw(10) << "ms" << std::setw(10) << "speedup"
+                  << std::setw(14) << "nodes" << std::setw(11) << "overhead" << std::setw(13) << "same move" << std::endl;
+
+        for (unsigned threads : threadCounts) {
+            BenchResult r = threads == 1 ? single : runBench(scheduler, threads, depth);
+            double speedup = r.ms > 0 ? static_cast<double>(single.ms) / r.ms : 0.0;
+            double overhead = single.nodes > 0 ? 100.0 * (static_cast<double>(r.nodes) / single.nodes - 1.0) : 0.0;
+            size_t sameMove = 0;
+            for (size_t i = 0; i < r.bestMoves.size(); ++i) {
+                sameMove += r.bestMoves[i] == single.bestMoves[i];
+            }
+
+            std::cout << std::setw(8) << threads << std::setw(10) << r.ms
+                      << std::setw(9) << std::fixed << std::setprecision(2) << speedup << "x"
+                      << std::setw(14) << r.nodes
+                      << std::setw(10) << std::setprecision(1) << overhead << "%"
+                      << std::setw(9) << sameMove << "/" << r.bestMoves.size() << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    return 0;
+}
@@ -48,6 +48,27 @@ inline bool none(uint64_t bb) {
     return bb == 0;
 }
 
+constexpr uint64_t FILE_A = 0x0101010101010101ULL;
+constexpr uint64_t FILE_H = FILE_A << 7;
+constexpr uint64_t RANK_1 = 0xFFULL;
+constexpr uint64_t RANK_4 = RANK_1 << (8 * 3);
+constexpr uint64_t RANK_5 = RANK_1 << (8 * 4);
+constexpr uint64_t RANK_8 = RANK_1 << (8 * 7);
+
+// Moves every square of bb one step by a square offset (+-8, +-7, +-9).
+// Squares that would wrap around the a- or h-file are dropped.
+template<int Offset>
+constexpr uint64_t shift(uint64_t bb) {
+    static_assert(Offset == 8 || Offset == -8 || Offset == 7 || Offset == -7 ||
+                  Offset == 9 || Offset == -9, "unsupported shift offset");
+    if constexpr (Offset == 8)  return bb << 8;
+    if constexpr (Offset == -8) return bb >> 8;
+    if constexpr (Offset == 7)  return (bb & ~FILE_A) << 7;
+    if constexpr (Offset == -7) return (bb & ~FILE_H) >> 7;
+    if constexpr (Offset == 9)  return (bb & ~FILE_H) << 9;
+    if constexpr (Offset == -9) return (bb & ~FILE_A) >> 9;
+}
+
 } // namespace chess
 
 #endif // BITBOARD_H
@@ -1,14 +1,16 @@
 #ifndef BITBOARD_INIT_H
 #define BITBOARD_INIT_H
 
-#include <chess/board/bitboard/zoborist.h>
-#include <chess/board/bitboard/precomputed_data.h>
+#include <chess/board/bitboard/magic.h>
+#include <chess/board/bitboard/cuckoo.h>
 
 namespace chess {
 
+// Zobrist keys and PrecomputedData are compile-time tables; the slider
+// attack tables and the repetition cuckoo table are filled at startup
 inline void initBitboardSystem() {
-    Zobrist::init();
-    PrecomputedData::init();
+    Magic::init();
+    initCuckoo();
 }
 
 } // namespace chess
@@ -1,50 +1,92 @@
 #ifndef BOARD_STATE_H
 #define BOARD_STATE_H
 #include <array>
-#include <vector>
 #include <cstdint>
 #include <string>
-#include <algorithm>
+#include <type_traits>
 #include <chess/board/pieces/piece_const.h>
+#include <chess/board/bitboard/bitboard.h>
+#include <chess/board/bitboard/psqt.h>
 
 namespace chess {
 
-struct PieceList {
-    std::vector<int> squares;
-    int count() const { return static_cast<int>(squares.size()); }
-    void add(int sq) { squares.push_back(sq); }
-    void remove(int sq) {
-        auto it = std::find(squares.begin(), squares.end(), sq);
-        if (it != squares.end()) squares.erase(it);
-    }
-    void move(int from, int to) {
-        auto it = std::find(squares.begin(), squares.end(), from);
-        if (it != squares.end()) *it = to;
-    }
-    void clear() { squares.clear(); }
-};
-
+// Plain-data position: copying one is a memcpy of a few cache lines, which
+// is what copy-make and handing positions to other threads rely on. Game
+// history lives in PositionHistory, next to the executor.
 struct BitboardState {
-    std::array<int,64> square{};
+    std::array<uint8_t,64> square{};
     
-    PieceList pawns[2];
-    PieceList knights[2];
-    PieceList bishops[2];
-    PieceList rooks[2];
-    PieceList queens[2];
+    // [colorIndex 0-1][pieceType PIECE_KING..PIECE_QUEEN]
+    uint64_t pieceBitboards[2][8]{};
+    uint64_t colorBitboards[2]{};
+    uint64_t allPiecesBitboard = 0;
     
-    int kingSquare[2]{};
+    int8_t kingSquare[2]{};
     bool whiteToMove = true;
     
     uint32_t gameState = 0;
     uint64_t zobristKey = 0;
-    
-    std::vector<uint64_t> repetitionHistory;
-    std::vector<uint64_t> zobristHistory;
+    // Zobrist key of the pawns alone, for the pawn-structure cache
+    uint64_t pawnKey = 0;
     
     int plyCount = 0;
     int fiftyMoveCounter = 0;
     
+    // White-minus-black material and piece-square score, and the game phase.
+    // Kept current by the piece helpers below so evaluation only has to
+    // blend two numbers.
+    Score psqScore = 0;
+    int phase = 0;
+    
+    uint64_t pieces(int colorIdx, int pieceType) const {
+        return pieceBitboards[colorIdx][pieceType];
+    }
+    uint64_t orthogonalSliders(int colorIdx) const {
+        return pieceBitboards[colorIdx][PIECE_ROOK] | pieceBitboards[colorIdx][PIECE_QUEEN];
+    }
+    uint64_t diagonalSliders(int colorIdx) const {
+        return pieceBitboards[colorIdx][PIECE_BISHOP] | pieceBitboards[colorIdx][PIECE_QUEEN];
+    }
+    int pieceCount(int colorIdx, int pieceType) const {
+        return popCount(pieceBitboards[colorIdx][pieceType]);
+    }
+    
+    // Mailbox and bitboards are kept in sync through these helpers
+    void addPiece(int sq, int piece) {
+        int c = isColor(piece, COLOR_WHITE) ? 0 : 1;
+        uint64_t b = bit(sq);
+        square[sq] = piece;
+        pieceBitboards[c][typeOf(piece)] |= b;
+        colorBitboards[c] |= b;
+        allPiecesBitboard |= b;
+        psqScore += PSQT[c][typeOf(piece)][sq];
+        phase += PHASE_WEIGHTS[typeOf(piece)];
+        if (typeOf(piece) == PIECE_KING) kingSquare[c] = sq;
+    }
+    void removePiece(int sq) {
+        int piece = square[sq];
+        int c = isColor(piece, COLOR_WHITE) ? 0 : 1;
+        uint64_t b = bit(sq);
+        square[sq] = PIECE_NONE;
+        pieceBitboards[c][typeOf(piece)] &= ~b;
+        colorBitboards[c] &= ~b;
+        allPiecesBitboard &= ~b;
+        psqScore -= PSQT[c][typeOf(piece)][sq];
+        phase -= PHASE_WEIGHTS[typeOf(piece)];
+    }
+    void movePiece(int from, int to) {
+        int piece = square[from];
+        int c = isColor(piece, COLOR_WHITE) ? 0 : 1;
+        uint64_t fromTo = bit(from) | bit(to);
+        square[to] = piece;
+        square[from] = PIECE_NONE;
+        pieceBitboards[c][typeOf(piece)] ^= fromTo;
+        colorBitboards[c] ^= fromTo;
+        allPiecesBitboard ^= fromTo;
+        psqScore += PSQT[c][typeOf(piece)][to] - PSQT[c][typeOf(piece)][from];
+        if (typeOf(piece) == PIECE_KING) kingSquare[c] = to;
+    }
+    
     void clear();
     int getPieceAt(int r, int c) const;
     int getPieceTypeAt(int r, int c) const;
@@ -56,6 +98,9 @@ struct BitboardState {
     std::string toFEN() const;
 };
 
+static_assert(std::is_trivially_copyable_v<BitboardState>, "BitboardState must stay memcpy-able");
+static_assert(sizeof(BitboardState) <= 256, "BitboardState should fit in four cache lines");
+
 constexpr uint32_t CR_WHITE_K = 1U;
 constexpr uint32_t CR_WHITE_Q = 2U;
 constexpr uint32_t CR_BLACK_K = 4U;
@@ -0,0 +1,22 @@
+#ifndef CUCKOO_H
+#define CUCKOO_H
+
+#include <chess/board/bitboard/board_state.h>
+#include <chess/board/bitboard/position_history.h>
+
+namespace chess {
+
+// Fills the cuckoo table; called from initBitboardSystem()
+void initCuckoo();
+
+// Upcoming-repetition test: true if the side to move has a reversible move
+// that returns to a position from the last maxPlies plies. Each of the
+// 3668 reversible piece moves is stored in a cuckoo hash keyed by its
+// Zobrist difference, so every earlier same-side position is one lookup.
+// Misses positions where the castling rights or en passant file changed
+// in between, which can never be repeated anyway.
+bool hasUpcomingRepetition(const BitboardState& state, const PositionHistory& history, int maxPlies);
+
+} // namespace chess
+
+#endif // CUCKOO_H
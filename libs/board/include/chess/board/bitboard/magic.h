@@ -0,0 +1,126 @@
+#ifndef MAGIC_H
+#define MAGIC_H
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CHESS_HAS_PEXT 1
+#include <immintrin.h>
+#else
+#define CHESS_HAS_PEXT 0
+#endif
+
+// GCC/Clang only allow BMI2 intrinsics inside functions compiled for that
+// target. The whole PEXT kernel is flattened into one such function so the
+// rest of the binary stays runnable on CPUs without BMI2. MSVC exposes the
+// intrinsics unconditionally.
+#if CHESS_HAS_PEXT && (defined(__GNUC__) || defined(__clang__))
+#define CHESS_TARGET_BMI2 __attribute__((target("bmi2")))
+#define CHESS_FLATTEN __attribute__((flatten))
+#else
+#define CHESS_TARGET_BMI2
+#define CHESS_FLATTEN
+#endif
+
+namespace chess {
+
+enum class SliderBackend {
+    Magic,
+    Pext
+};
+
+// Fancy-magic sliding attack lookup. All squares share one attack table per
+// slider type, each square owning a slice of (1 << relevantBits) entries.
+// A second set of tables indexed by PEXT is filled alongside for BMI2 hosts.
+class Magic {
+public:
+    static void init();
+
+    static uint64_t rookAttacks(int square, uint64_t occupancy) {
+        const MagicEntry& m = rookMagics[square];
+        return m.attacks[((occupancy & m.mask) * m.magic) >> m.shift];
+    }
+
+    static uint64_t bishopAttacks(int square, uint64_t occupancy) {
+        const MagicEntry& m = bishopMagics[square];
+        return m.attacks[((occupancy & m.mask) * m.magic) >> m.shift];
+    }
+
+    static uint64_t queenAttacks(int square, uint64_t occupancy) {
+        return rookAttacks(square, occupancy) | bishopAttacks(square, occupancy);
+    }
+
+#if CHESS_HAS_PEXT
+    // Only call these when pextSupported() is true
+    CHESS_TARGET_BMI2 static uint64_t rookAttacksPext(int square, uint64_t occupancy) {
+        const PextEntry& p = rookPext[square];
+        return p.attacks[_pext_u64(occupancy, p.mask)];
+    }
+
+    CHESS_TARGET_BMI2 static uint64_t bishopAttacksPext(int square, uint64_t occupancy) {
+        const PextEntry& p = bishopPext[square];
+        return p.attacks[_pext_u64(occupancy, p.mask)];
+    }
+#endif
+
+    // Slow ray walk, used to fill the tables and as a reference implementation
+    static uint64_t slidingAttacks(int square, uint64_t occupancy, bool orthogonal);
+
+    // PEXT lookups may only run when the CPU reports BMI2. It is preferred
+    // unless PEXT is microcoded (AMD before Zen 3).
+    static bool pextSupported() { return hasPext; }
+    static SliderBackend preferredBackend() {
+        return hasFastPext ? SliderBackend::Pext : SliderBackend::Magic;
+    }
+
+private:
+    struct MagicEntry {
+        uint64_t mask;
+        uint64_t magic;
+        uint64_t* attacks;
+        int shift;
+    };
+
+    struct PextEntry {
+        uint64_t mask;
+        uint64_t* attacks;
+    };
+
+    static constexpr int ROOK_TABLE_SIZE = 0x19000;
+    static constexpr int BISHOP_TABLE_SIZE = 0x1480;
+
+    static MagicEntry rookMagics[64];
+    static MagicEntry bishopMagics[64];
+    static uint64_t rookTable[ROOK_TABLE_SIZE];
+    static uint64_t bishopTable[BISHOP_TABLE_SIZE];
+
+    static PextEntry rookPext[64];
+    static PextEntry bishopPext[64];
+    static uint64_t rookPextTable[ROOK_TABLE_SIZE];
+    static uint64_t bishopPextTable[BISHOP_TABLE_SIZE];
+
+    static bool hasPext;
+    static bool hasFastPext;
+    static bool initialized;
+
+    static void initSlider(MagicEntry* magics, const uint64_t* magicNumbers, uint64_t* table,
+                           PextEntry* pext, uint64_t* pextTable, bool orthogonal);
+    static void detectPext();
+};
+
+// Slider lookup policies for kernels templated on the attack backend
+struct MagicSliders {
+    static uint64_t rook(int square, uint64_t occupancy) { return Magic::rookAttacks(square, occupancy); }
+    static uint64_t bishop(int square, uint64_t occupancy) { return Magic::bishopAttacks(square, occupancy); }
+};
+
+#if CHESS_HAS_PEXT
+struct PextSliders {
+    CHESS_TARGET_BMI2 static uint64_t rook(int square, uint64_t occupancy) { return Magic::rookAttacksPext(square, occupancy); }
+    CHESS_TARGET_BMI2 static uint64_t bishop(int square, uint64_t occupancy) { return Magic::bishopAttacksPext(square, occupancy); }
+};
+#endif
+
+} // namespace chess
+
+#endif // MAGIC_H
@@ -4,12 +4,15 @@
 #include <cstdint>
 #include <chess/board/bitboard/move.h>
 #include <chess/board/bitboard/board_state.h>
+#include <chess/board/bitboard/position_history.h>
+#include <chess/enums.h>
 
 namespace chess {
 
 struct UndoState {
     uint32_t previousGameState;
     uint64_t previousZobrist;
+    uint64_t previousPawnKey;
     int capturedPiece;
     int previousFiftyMove;
     int previousPlyCount;
@@ -17,13 +20,27 @@ struct UndoState {
 
 class BBMoveExecutor {
 public:
-    BBMoveExecutor(BitboardState& state) : state(state) {}
+    // history is optional; perft and other callers that never look for
+    // repetitions can leave it out
+    BBMoveExecutor(BitboardState& state, PositionHistory* history = nullptr)
+        : state(state), history(history) {}
     
+    // Both dispatch once on the side to move into the Color-templated versions
     UndoState makeMove(const BBMove& move);
     void unmakeMove(const BBMove& move, const UndoState& undo); 
     
+    // Passes the turn for null-move pruning: flips the side to move and
+    // clears the en passant file. The fifty-move counter restarts so
+    // repetition checks do not look back across the null move.
+    UndoState makeNullMove();
+    void unmakeNullMove(const UndoState& undo);
+    
 private:
     BitboardState& state;
+    PositionHistory* history;
+    
+    template<Color Us> UndoState makeMove(const BBMove& move);
+    template<Color Us> void unmakeMove(const BBMove& move, const UndoState& undo);
 };
 
 } // namespace chess
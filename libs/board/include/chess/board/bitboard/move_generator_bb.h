@@ -4,7 +4,10 @@
 #include <vector>
 #include <cstdint>
 #include <chess/board/bitboard/move.h>
+#include <chess/board/bitboard/move_list.h>
 #include <chess/board/bitboard/board_state.h>
+#include <chess/board/bitboard/magic.h>
+#include <chess/enums.h>
 
 // Forward declarations
 class BoardBB;
@@ -16,19 +19,35 @@ public:
     MoveGeneratorBB();
 
     friend class BoardBB;
+
+    // Captures and Quiets partition All; en passant and capture-promotions
+    // count as captures, castling and push-promotions as quiets
+    enum class GenType {
+        All,
+        Captures,
+        Quiets
+    };
     
+    // Hot path for search and perft: writes into a caller-owned buffer
+    void generateMoves(BitboardState& state, MoveList& moveList, GenType type);
+    void generateMoves(BitboardState& state, MoveList& moveList, bool capturesOnly = false);
     std::vector<BBMove> generateMoves(BitboardState& state, bool capturesOnly = false);
 
     bool getInCheck() const { return inCheck; }
+
+    // Slider lookup used by every generator. Picked from CPUID when the first
+    // generator is built; forcing PEXT fails on CPUs without BMI2.
+    static bool setSliderBackend(SliderBackend backend);
+    static SliderBackend getSliderBackend();
     
 private:
-    std::vector<BBMove> moves;
-    bool isWhiteToMove;
-    int friendlyColour;
-    int opponentColour;
+    static SliderBackend sliderBackend;
+    static bool sliderBackendSelected;
+    static void selectSliderBackend();
+
+
+    MoveList* moves = nullptr;
     int friendlyKingSquare;
-    int friendlyColourIndex;
-    int opponentColourIndex;
     
     bool inCheck;
     bool inDoubleCheck;
@@ -42,30 +61,50 @@ private:
     uint64_t opponentSlidingAttackMap;
     
     bool genQuiets;
+    bool genCaptures;
     BitboardState* board;
     
+    // Everything colour-dependent is templated on the side to move, so the
+    // only runtime branch on colour is in generateWithMagic/generateWithPext
     void init();
-    void calculateAttackData();
-    void genSlidingAttackMap();
-    void updateSlidingAttackPiece(int startSquare, int startDirIndex, int endDirIndex);
+    template<Color Us, typename Sliders> void generate();
+    void generateWithMagic();
+#if CHESS_HAS_PEXT
+    void generateWithPext();
+#endif
+    template<Color Us, typename Sliders> void calculateAttackData();
+    template<Color Us, typename Sliders> void genSlidingAttackMap();
     
-    void generateKingMoves();
-    void generateSlidingMoves();
-    void generateSlidingPieceMoves(int startSquare, int startDirIndex, int endDirIndex);
-    void generateKnightMoves();
-    void generatePawnMoves();
+    template<Color Us> void generateKingMoves();
+    template<Color Us, typename Sliders> void generateSlidingMoves();
+    template<Color Us> void generateSlidingPieceMoves(int startSquare, uint64_t attacks);
+    template<Color Us> void generateKnightMoves();
+    template<Color Us, typename Sliders> void generatePawnMoves();
+    template<int Offset> void serializePawnMoves(uint64_t targets, BBMove::Flag flag);
+    template<int Offset> void serializePromotions(uint64_t targets);
     void makePromotionMoves(int fromSquare, int toSquare);
     
-    bool isMovingAlongRay(int rayDir, int startSquare, int targetSquare);
     bool isPinnedFunc(int square);
     bool squareIsInCheckRay(int square);
-    bool hasKingsideCastleRight();
-    bool hasQueensideCastleRight();
+    template<Color Us> bool hasKingsideCastleRight();
+    template<Color Us> bool hasQueensideCastleRight();
     bool squareIsAttacked(int square);
-    bool inCheckAfterEnPassant(int startSquare, int targetSquare, int epCapturedPawnSquare);
-    bool squareAttackedAfterEPCapture(int epCaptureSquare, int capturingPawnStartSquare);
+    template<Color Us, typename Sliders> bool inCheckAfterEnPassant(int startSquare, int targetSquare, int epCapturedPawnSquare);
 };
 
+// Validate a single move against a position without generating the move
+// list, e.g. a hash or killer move that may come from another position.
+// Any 16-bit encoding is accepted. Both need Magic::init(), which any
+// MoveGeneratorBB has already done.
+//
+// isPseudoLegal: the side to move has a piece that can make this move by the
+// movement rules (occupancy, flags, castling rights, en passant square).
+// isLegal: additionally the move does not leave the mover's king attacked,
+// and castling does not start in, pass through or land in check. isLegal(m)
+// holds exactly when generateMoves() would produce m.
+bool isPseudoLegal(const BitboardState& state, BBMove move);
+bool isLegal(const BitboardState& state, BBMove move);
+
 } // namespace chess
 
 #endif // MOVE_GENERATOR_BB_H
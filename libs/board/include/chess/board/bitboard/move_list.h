@@ -0,0 +1,41 @@
+#ifndef MOVE_LIST_H
+#define MOVE_LIST_H
+
+#include <cstddef>
+#include <chess/board/bitboard/move.h>
+
+namespace chess {
+
+// Fixed-capacity move buffer that lives on the stack of the caller. No legal
+// position has more than 218 moves, so generation never overflows it.
+class MoveList {
+public:
+    static constexpr int MAX_MOVES = 256;
+
+    MoveList() : count(0) {}
+
+    void push_back(const BBMove& move) { moves[count++] = move; }
+
+    template<typename... Args>
+    void emplace_back(Args... args) { moves[count++] = BBMove(args...); }
+
+    void clear() { count = 0; }
+    size_t size() const { return static_cast<size_t>(count); }
+    bool empty() const { return count == 0; }
+
+    BBMove& operator[](size_t i) { return moves[i]; }
+    const BBMove& operator[](size_t i) const { return moves[i]; }
+
+    BBMove* begin() { return moves; }
+    BBMove* end() { return moves + count; }
+    const BBMove* begin() const { return moves; }
+    const BBMove* end() const { return moves + count; }
+
+private:
+    BBMove moves[MAX_MOVES];
+    int count;
+};
+
+} // namespace chess
+
+#endif // MOVE_LIST_H
@@ -0,0 +1,45 @@
+#ifndef POSITION_HISTORY_H
+#define POSITION_HISTORY_H
+
+#include <cstdint>
+
+namespace chess {
+
+// Zobrist keys of the positions before each move made so far. Kept outside
+// BitboardState so the position itself stays trivially copyable. Stored as
+// a ring: only the last fiftyMoveCounter plies can repeat, and that window
+// never comes close to CAPACITY.
+class PositionHistory {
+public:
+    static constexpr int CAPACITY = 1024;
+
+    void push(uint64_t key) { keys[count++ & (CAPACITY - 1)] = key; }
+    void pop() { --count; }
+    void clear() { count = 0; }
+    int size() const { return count; }
+
+    // Key of the position pliesAgo plies back (1 = before the last move)
+    uint64_t keyAt(int pliesAgo) const { return keys[(count - pliesAgo) & (CAPACITY - 1)]; }
+
+    // True if key occurs within the last maxPlies entries. Only positions
+    // with the same side to move can match, i.e. every second entry, and
+    // the nearest possible repetition is four plies back.
+    bool isRepetition(uint64_t key, int maxPlies) const {
+        int n = maxPlies < count ? maxPlies : count;
+        if (n > CAPACITY) n = CAPACITY;
+        for (int i = 4; i <= n; i += 2) {
+            if (keyAt(i) == key) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    uint64_t keys[CAPACITY];
+    int count = 0;
+};
+
+} // namespace chess
+
+#endif // POSITION_HISTORY_H
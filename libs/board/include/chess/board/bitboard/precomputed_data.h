@@ -6,25 +6,114 @@
 
 namespace chess {
 
+// Table builders, evaluated at compile time so the tables land in read-only
+// data and need no init call. The two 64x64 ray tables are built in
+// precomputed_data.cpp instead, so their cost is paid in one translation
+// unit rather than in every file including this header.
+namespace precomputed_detail {
+
+using SquareBitboards = std::array<uint64_t, 64>;
+
+struct LeaperMoves {
+    std::array<std::array<int, 8>, 64> targets{};
+    std::array<int, 64> count{};
+    SquareBitboards attacks{};
+};
+
+constexpr int DIRECTION_OFFSETS[8] = {8, -8, -1, 1, 7, -7, 9, -9};
+
+constexpr int minInt(int a, int b) { return a < b ? a : b; }
+
+constexpr std::array<std::array<int, 8>, 64> buildNumSquaresToEdge() {
+    std::array<std::array<int, 8>, 64> table{};
+    for (int square = 0; square < 64; ++square) {
+        int rank = square / 8;
+        int file = square % 8;
+        int north = 7 - rank;
+        int south = rank;
+        int west = file;
+        int east = 7 - file;
+
+        table[square] = {north, south, west, east,
+                         minInt(north, west), minInt(south, east),
+                         minInt(north, east), minInt(south, west)};
+    }
+    return table;
+}
+
+// deltas are {rank, file} steps, in the order moves should be generated
+constexpr LeaperMoves buildLeaperMoves(const int (&deltas)[8][2]) {
+    LeaperMoves table{};
+    for (int square = 0; square < 64; ++square) {
+        int rank = square / 8;
+        int file = square % 8;
+        for (const auto& delta : deltas) {
+            int newRank = rank + delta[0];
+            int newFile = file + delta[1];
+            if (newRank >= 0 && newRank < 8 && newFile >= 0 && newFile < 8) {
+                int targetSquare = newRank * 8 + newFile;
+                table.targets[square][table.count[square]++] = targetSquare;
+                table.attacks[square] |= 1ULL << targetSquare;
+            }
+        }
+    }
+    return table;
+}
+
+constexpr int KNIGHT_DELTAS[8][2] = {
+    {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
+    {1, -2}, {1, 2}, {2, -1}, {2, 1}
+};
+
+constexpr int KING_DELTAS[8][2] = {
+    {-1, -1}, {-1, 0}, {-1, 1}, {0, -1},
+    {0, 1}, {1, -1}, {1, 0}, {1, 1}
+};
+
+constexpr LeaperMoves KNIGHT_MOVES = buildLeaperMoves(KNIGHT_DELTAS);
+constexpr LeaperMoves KING_MOVES = buildLeaperMoves(KING_DELTAS);
+
+constexpr std::array<std::array<uint64_t, 2>, 64> buildPawnAttacks() {
+    std::array<std::array<uint64_t, 2>, 64> table{};
+    for (int square = 0; square < 64; ++square) {
+        int file = square % 8;
+        int rank = square / 8;
+
+        if (rank < 7) {
+            if (file > 0) table[square][0] |= 1ULL << (square + 7);
+            if (file < 7) table[square][0] |= 1ULL << (square + 9);
+        }
+        if (rank > 0) {
+            if (file > 0) table[square][1] |= 1ULL << (square - 9);
+            if (file < 7) table[square][1] |= 1ULL << (square - 7);
+        }
+    }
+    return table;
+}
+
+} // namespace precomputed_detail
+
 class PrecomputedData {
 public:
-    static void init();
-    
     static constexpr int directionOffsets[8] = {8, -8, -1, 1, 7, -7, 9, -9};
-    static int numSquaresToEdge[64][8];
-    
-    static uint64_t knightAttackBitboards[64];
-    static uint64_t kingAttackBitboards[64];
-    static uint64_t pawnAttackBitboards[64][2];
-    
-    static int* knightMoves[64];
-    static int numKnightMoves[64];
-    static int* kingMoves[64];
-    static int numKingMoves[64];
-    
-    static int pawnAttackDirections[2][2];
-    static int directionLookup[127];
-    
+    static constexpr std::array<std::array<int, 8>, 64> numSquaresToEdge = precomputed_detail::buildNumSquaresToEdge();
+
+    static constexpr std::array<uint64_t, 64> knightAttackBitboards = precomputed_detail::KNIGHT_MOVES.attacks;
+    static constexpr std::array<uint64_t, 64> kingAttackBitboards = precomputed_detail::KING_MOVES.attacks;
+    static constexpr std::array<std::array<uint64_t, 2>, 64> pawnAttackBitboards = precomputed_detail::buildPawnAttacks();
+
+    // Squares strictly between two aligned squares (empty if not aligned)
+    static const std::array<std::array<uint64_t, 64>, 64> betweenBitboards;
+    // Full edge-to-edge line through two aligned squares (empty if not aligned)
+    static const std::array<std::array<uint64_t, 64>, 64> lineBitboards;
+
+    static constexpr std::array<std::array<int, 8>, 64> knightMoves = precomputed_detail::KNIGHT_MOVES.targets;
+    static constexpr std::array<int, 64> numKnightMoves = precomputed_detail::KNIGHT_MOVES.count;
+    static constexpr std::array<std::array<int, 8>, 64> kingMoves = precomputed_detail::KING_MOVES.targets;
+    static constexpr std::array<int, 64> numKingMoves = precomputed_detail::KING_MOVES.count;
+
+    static constexpr int pawnAttackDirections[2][2] = {{4, 6}, {7, 5}};
+
     static constexpr int NORTH = 0;
     static constexpr int SOUTH = 1;
     static constexpr int WEST = 2;
@@ -33,15 +122,11 @@ public:
     static constexpr int SOUTH_EAST = 5;
     static constexpr int NORTH_EAST = 6;
     static constexpr int SOUTH_WEST = 7;
-    
+
     static constexpr int knightOffsets[8] = {15, 17, -17, -15, 10, -6, 6, -10};
     static constexpr int kingOffsets[8] = {8, -8, 1, -1, 7, -7, 9, -9};
-    
-private:
-    static bool initialized;
 };
 
 } // namespace chess
 
 #endif // PRECOMPUTED_DATA_H
-
@@ -0,0 +1,44 @@
+#ifndef PSQT_H
+#define PSQT_H
+
+#include <array>
+#include <cstdint>
+
+namespace chess {
+
+// Middlegame and endgame values packed into one integer so both are updated
+// with a single add: endgame in the low 16 bits, middlegame in the high 16
+// bits, which absorb the borrow when the endgame half is negative
+using Score = int32_t;
+
+constexpr Score makeScore(int mg, int eg) {
+    return static_cast<Score>(static_cast<uint32_t>(mg) << 16) + eg;
+}
+
+constexpr int mgValue(Score score) {
+    return static_cast<int16_t>(static_cast<uint32_t>(score + 0x8000) >> 16);
+}
+
+constexpr int egValue(Score score) {
+    return static_cast<int16_t>(static_cast<uint32_t>(score));
+}
+
+// Game phase: the sum of these over all pieces on the board, MAX_PHASE with
+// the full set of pieces and 0 with only kings and pawns left
+constexpr int PHASE_WEIGHTS[8] = {0, 0, 0, 1, 0, 1, 2, 4};
+constexpr int MAX_PHASE = 24;
+
+namespace psqt_detail {
+
+using SideTable = std::array<std::array<Score, 64>, 8>;
+
+} // namespace psqt_detail
+
+// [colorIndex][pieceType][square]; material plus piece-square value from
+// white's point of view, built once in psqt.cpp rather than in every file
+// that includes board_state.h
+extern const std::array<psqt_detail::SideTable, 2> PSQT;
+
+} // namespace chess
+
+#endif // PSQT_H
@@ -0,0 +1,44 @@
+#ifndef SEE_H
+#define SEE_H
+
+#include <cstdint>
+#include <chess/board/bitboard/move.h>
+#include <chess/board/bitboard/board_state.h>
+
+namespace chess {
+
+// Exchange values indexed by piece type. The king only matters as the last
+// capturer of an exchange, so its value just has to exceed everything else.
+constexpr int SEE_PIECE_VALUES[8] = {
+    0,      // PIECE_NONE
+    20000,  // PIECE_KING
+    100,    // PIECE_PAWN
+    300,    // PIECE_KNIGHT
+    0,
+    320,    // PIECE_BISHOP
+    500,    // PIECE_ROOK
+    900     // PIECE_QUEEN
+};
+
+// Pieces of both colours attacking square, with sliders looking through the
+// given occupancy. Only pieces still on occupancy are returned, so clearing
+// a capturer from occupancy uncovers the x-ray attackers behind it.
+uint64_t attackersTo(const BitboardState& state, int square, uint64_t occupancy);
+
+// Whether the side to move gives check by playing move, directly or by
+// uncovering a slider, worked out without making the move
+bool givesCheck(const BitboardState& state, BBMove move);
+
+// Static exchange evaluation: material won by the side to move if both sides
+// keep recapturing on the target square with their least valuable attacker
+// and may stop whenever continuing would lose. Pins are ignored. Quiet moves
+// score what they put en prise, castling scores 0.
+int see(const BitboardState& state, BBMove move);
+
+// see(state, move) >= threshold, skipping the exchange when the first
+// capture alone decides it
+bool seeGE(const BitboardState& state, BBMove move, int threshold);
+
+} // namespace chess
+
+#endif // SEE_H
@@ -1,77 +1,125 @@
 #ifndef TRANS_POSITION_TABLE_H
 #define TRANS_POSITION_TABLE_H
 
+#include <atomic>
 #include <cstdint>
-#include <vector>
+#include <memory>
 #include <chess/board/bitboard/move.h>
 
-// Forward declarations
-class BoardBB;
-namespace chess {
-    struct BitboardState;
-}
-
 using byte = unsigned char;
 
+// One 8-byte slot, packed into a single word so it is always read and
+// written whole: search threads share it without locks and never see half
+// of one store and half of another.
+//   bits  0-15 key check (top 16 bits of the Zobrist key)
+//   bits 16-31 value (compressed, see TranspositionTable::compressValue)
+//   bits 32-39 depth   40-41 bound type   42-47 generation
+//   bits 48-63 move
+// The low key bits select the cluster, so together with the 16-bit check a
+// false match needs a collision in well over 30 key bits; a TT move is also
+// checked for legality before it is played.
 struct TTEntry {
-    uint64_t key;
-    int value;
-    int depth;
-    byte nodeType;
-    chess::BBMove move;
+    static constexpr int GENERATION_BITS = 6;
+    static constexpr int GENERATION_MASK = (1 << GENERATION_BITS) - 1;
+
+    std::atomic<uint64_t> data{0};
 
-    TTEntry() : key(0), value(0), depth(0), nodeType(0), move() {}
+    static uint16_t keyCheckOf(uint64_t key) { return static_cast<uint16_t>(key >> 48); }
 
-    TTEntry(uint64_t k, int v, int d, byte nt, chess::BBMove m)
-        : key(k), value(v), depth(d), nodeType(nt), move(m) {}
+    static uint64_t pack(uint16_t keyCheck, int16_t value, int depth, int nodeType, int generation,
+                         chess::BBMove move) {
+        return keyCheck
+             | static_cast<uint64_t>(static_cast<uint16_t>(value)) << 16
+             | static_cast<uint64_t>(static_cast<uint8_t>(depth)) << 32
+             | static_cast<uint64_t>(nodeType & 3) << 40
+             | static_cast<uint64_t>(generation & GENERATION_MASK) << 42
+             | static_cast<uint64_t>(move.value) << 48;
+    }
+    static uint16_t keyCheck(uint64_t data) { return static_cast<uint16_t>(data); }
+    static int16_t value(uint64_t data) { return static_cast<int16_t>(static_cast<uint16_t>(data >> 16)); }
+    static int depth(uint64_t data) { return static_cast<uint8_t>(data >> 32); }
+    static int nodeType(uint64_t data) { return static_cast<int>((data >> 40) & 3); }
+    static int generation(uint64_t data) { return static_cast<int>((data >> 42) & GENERATION_MASK); }
+    static chess::BBMove move(uint64_t data) { return chess::BBMove(static_cast<uint16_t>(data >> 48)); }
 
     int getSize() const {
         return sizeof(TTEntry);
     }
-}; 
+};
+
+// The entries one key can live in, filling exactly one cache line, so a
+// probe costs a single cache miss
+struct alignas(64) TTCluster {
+    static constexpr int NUM_ENTRIES = 8;
+    TTEntry entries[NUM_ENTRIES];
+};
+
+static_assert(sizeof(TTCluster) == 64, "a TT cluster must fill one cache line");
 
+// Keys are passed in by the caller, so one table can be shared by searches
+// running on different boards (Lazy SMP). The table is kept from one search
+// to the next; newSearch() starts a new generation, and when a cluster is
+// full the entry given up is the shallowest, counting each generation of
+// age as AGE_DEPTH_WEIGHT plies of depth. A key's own entry is overwritten
+// unless the new result is a much shallower bound from the same search.
 class TranspositionTable {
 public:
     static constexpr int EXACT = 0;
     static constexpr int LOWER_BOUND = 1;
     static constexpr int UPPER_BOUND = 2;
     static constexpr int LOOKUP_FAILED = -1;
-    
+
     static constexpr int MATE_SCORE = 100000;
     static constexpr int MAX_MATE_DEPTH = 1000;
 
-    TranspositionTable(BoardBB& b, size_t sizeInMB = 64);
+    static constexpr int AGE_DEPTH_WEIGHT = 8;
+    // A non-exact result for a key already stored this search only replaces
+    // the entry when it is at most this many plies shallower
+    static constexpr int SAME_KEY_DEPTH_MARGIN = 3;
+
+    TranspositionTable(size_t sizeInMB = 64);
     ~TranspositionTable();
 
     friend class AI_BB;
 
-    uint64_t getIndex() const;
-
-    void storeEval(int depth, int plySearched, int eval, int evalType, const chess::BBMove& move);
+    uint64_t getIndex(uint64_t key) const;
 
-    chess::BBMove getStoredMove() const;
+    void storeEval(uint64_t key, int depth, int plySearched, int eval, int evalType, const chess::BBMove& move);
 
-    int getStoredValue() const;
+    chess::BBMove getStoredMove(uint64_t key) const;
 
-    int probeEval(int depth, int plyFromRoot, int alpha, int beta);
+    int probeEval(uint64_t key, int depth, int plyFromRoot, int alpha, int beta) const;
 
     int correctMateScoreForStorage(int score, int numPlySearched) const;
     int correctMateScoreForRetrieval(int score, int numPlyFromRoot) const;
 
+    // Values are stored in 16 bits: ordinary scores as they are, mate
+    // scores moved down next to them with their distance to mate kept
+    static int16_t compressValue(int score);
+    static int expandValue(int16_t stored);
+
+    // Call before each search; clear() also resets the generation
+    void newSearch() { generation = (generation + 1) & TTEntry::GENERATION_MASK; }
+    int getGeneration() const { return generation; }
+
     void clear();
 
     void setEnabled(bool enabled) { isEnabled = enabled; }
     bool getEnabled() const { return isEnabled; }
 
+    // Clusters, and entries over all clusters
     size_t getSize() const { return tableSize; }
     size_t getNumEntries() const { return numEntries; }
 
 private:
-    std::vector<TTEntry> table;
+    // Data of the entry holding key, or 0 when there is none
+    uint64_t findEntry(uint64_t key) const;
+
+    std::unique_ptr<TTCluster[]> table;
     size_t tableSize;
     size_t numEntries;
-    BoardBB& board;
     bool isEnabled;
+    int generation = 0;
 };
 
-#endif // TRANS_POSITION_TABLE_H
\ No newline at end of file
+#endif // TRANS_POSITION_TABLE_H
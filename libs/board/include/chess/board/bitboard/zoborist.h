@@ -2,58 +2,88 @@
 #define ZOBRIST_H
 
 #include <cstdint>
-#include <array>
-#include <random>
 
 namespace chess {
+
+namespace zobrist_detail {
+
+struct Keys {
+    // [pieceType 1-6][colorIndex 0-1][square 0-63]
+    uint64_t pieces[8][2][64]{};
+    // [castlingRights 0-15]
+    uint64_t castlingRights[16]{};
+    // [file 0-7]
+    uint64_t enPassantFile[9]{};
+    // Side to move toggle
+    uint64_t sideToMove = 0;
+};
+
+// splitmix64 with a fixed seed: the same keys in every build and process, so
+// hashes can be compared across runs or stored on disk
+constexpr uint64_t splitMix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr Keys buildKeys() {
+    Keys keys{};
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+
+    for (int pieceType = 0; pieceType < 8; ++pieceType) {
+        for (int color = 0; color < 2; ++color) {
+            for (int square = 0; square < 64; ++square) {
+                keys.pieces[pieceType][color][square] = splitMix64(state);
+            }
+        }
+    }
+    for (int i = 0; i < 16; ++i) {
+        keys.castlingRights[i] = splitMix64(state);
+    }
+    for (int i = 0; i < 9; ++i) {
+        keys.enPassantFile[i] = splitMix64(state);
+    }
+    keys.sideToMove = splitMix64(state);
+    return keys;
+}
+
+} // namespace zobrist_detail
+
 class Zobrist {
 public:
-    static void init();
     
     // Get zobrist value for piece on square
     // pieceType: PIECE_PAWN, PIECE_KNIGHT, etc. (1-6)
     // colorIndex: 0 for white, 1 for black
     // square: 0-63
-    static uint64_t piece(int pieceType, int colorIndex, int square) {
-        return piecesArray[pieceType][colorIndex][square];
+    static constexpr uint64_t piece(int pieceType, int colorIndex, int square) {
+        return keys.pieces[pieceType][colorIndex][square];
     }
     
     // Get zobrist value for castling rights (0-15)
-    static uint64_t castlingRights(int rights) {
-        return castlingRightsArray[rights];
+    static constexpr uint64_t castlingRights(int rights) {
+        return keys.castlingRights[rights];
     }
     
     // Get zobrist value for en passant file (0-7)
-    static uint64_t enPassantFile(int file) {
-        return enPassantFileArray[file];
+    static constexpr uint64_t enPassantFile(int file) {
+        return keys.enPassantFile[file];
     }
     
     // Get zobrist value for side to move
-    static uint64_t sideToMove() {
-        return sideToMoveValue;
+    static constexpr uint64_t sideToMove() {
+        return keys.sideToMove;
     }
     
     // Calculate full zobrist key from scratch
     static uint64_t calculateZobristKey(const struct BitboardState& state);
+    
+    // Calculate the pawn-only key from scratch
+    static uint64_t calculatePawnKey(const struct BitboardState& state);
 
 private:
-    // [pieceType 1-6][colorIndex 0-1][square 0-63]
-    static uint64_t piecesArray[8][2][64];
-    
-    // [castlingRights 0-15]
-    static uint64_t castlingRightsArray[16];
-    
-    // [file 0-7]
-    static uint64_t enPassantFileArray[9];
-    
-    // Side to move toggle
-    static uint64_t sideToMoveValue;
-    
-    static bool initialized;
-    
-    // Generate random 64-bit number
-    static uint64_t randomUInt64();
-    static std::mt19937_64& getRNG();
+    static constexpr zobrist_detail::Keys keys = zobrist_detail::buildKeys();
 };
 
 } // namespace chess
@@ -25,6 +25,7 @@ namespace chess {
     struct BBMove;
     struct UndoState;
     class BBMoveExecutor;
+    class PositionHistory;
 }
 
 class BoardBB {
@@ -51,14 +52,16 @@ private:
     std::unique_ptr<chess::BitboardState> bbState;
     std::unique_ptr<chess::MoveGeneratorBB> bbGenerator;
     std::unique_ptr<chess::BBMoveExecutor> moveExecutor;
+    std::unique_ptr<chess::PositionHistory> history;
     
     std::string startFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
     Color currentPlayer = WHITE;
     int halfMoveClock = 0;
     int fullMoveNumber = 1;
 
-    mutable std::vector<chess::BBMove> whiteMoves;
-    mutable std::vector<chess::BBMove> blackMoves;
+    // Move counts from the last getAllLegalMoves call, for mate/stalemate checks
+    mutable size_t numWhiteMoves = 0;
+    mutable size_t numBlackMoves = 0;
 
 
         
@@ -73,6 +76,8 @@ public:
     ~BoardBB();
     BoardBB(const BoardBB& other);
     void loadFEN(const std::string& fen, SDL_Renderer* gameRenderer);
+    // Copies the position and game history of another board, without any UI state
+    void copyPositionFrom(const BoardBB& other);
     void syncUIFromBBState(SDL_Renderer* gameRenderer);
     void initializeBoard(SDL_Renderer* gameRenderer);
     void resetBoard(SDL_Renderer* gameRenderer);
@@ -88,6 +93,9 @@ public:
 
     chess::UndoState executeMove(const chess::BBMove& move, bool trackUndo = true);
     void undoMove(const chess::BBMove& move, chess::UndoState& undo);
+    // Search only: passes the turn without touching the UI
+    chess::UndoState executeNullMove();
+    void undoNullMove(const chess::UndoState& undo);
     
     bool isCheckMate(Color color);
     bool isStaleMate(Color color);
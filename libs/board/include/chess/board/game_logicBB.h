@@ -22,7 +22,9 @@ public:
     void makeMove(const chess::BBMove& move, BoardBB& board);
     void update(BoardBB& board);
     void setAI(std::shared_ptr<class AI_BB> aiInstance, Color aiColor);
-    void setAISettings(int searchDepth, unsigned threadCount);
+    // moveTimeMs caps each AI move on top of the search depth; 0 searches
+    // to depth however long that takes
+    void setAISettings(int searchDepth, unsigned threadCount, int moveTimeMs);
 
     int getPieceAt(int row, int col, const BoardBB& board) const;
 
@@ -43,6 +45,7 @@ private:
     std::future<std::pair<std::pair<chess::BBMove, int>, std::string>> aiFuture;
     std::atomic<bool> aiSearchRunning{false};
     int aiSearchDepth = 4;
+    int aiMoveTimeMs = 3000;
     unsigned aiThreadCount = 1;
 };
 
@@ -10,20 +10,20 @@ void BitboardState::clear() {
     square.fill(PIECE_NONE);
     
     for (int i = 0; i < 2; ++i) {
-        pawns[i].clear();
-        knights[i].clear();
-        bishops[i].clear();
-        rooks[i].clear();
-        queens[i].clear();
+        for (uint64_t& bb : pieceBitboards[i]) bb = 0;
+        colorBitboards[i] = 0;
         kingSquare[i] = -1;
     }
+    allPiecesBitboard = 0;
     
     whiteToMove = true;
     gameState = 0;
     zobristKey = 0;
-    repetitionHistory.clear();
+    pawnKey = 0;
     plyCount = 0;
     fiftyMoveCounter = 0;
+    psqScore = 0;
+    phase = 0;
 }
 
 int BitboardState::getPieceAt(int r, int c) const {
@@ -65,7 +65,6 @@ void BitboardState::loadFromFEN(const std::string& fen) {
             int sq = rank * 8 + file;
             int pieceType = PIECE_NONE;
             int color = std::isupper(c) ? COLOR_WHITE : COLOR_BLACK;
-            int colorIdx = (color == COLOR_WHITE) ? 0 : 1;
             
             char lower = std::tolower(c);
             switch (lower) {
@@ -77,17 +76,7 @@ void BitboardState::loadFromFEN(const std::string& fen) {
                 case 'k': pieceType = PIECE_KING; break;
             }
             
-            int piece = pieceType | color;
-            square[sq] = piece;
-            
-            switch (pieceType) {
-                case PIECE_PAWN:   pawns[colorIdx].add(sq); break;
-                case PIECE_KNIGHT: knights[colorIdx].add(sq); break;
-                case PIECE_BISHOP: bishops[colorIdx].add(sq); break;
-                case PIECE_ROOK:   rooks[colorIdx].add(sq); break;
-                case PIECE_QUEEN:  queens[colorIdx].add(sq); break;
-                case PIECE_KING:   kingSquare[colorIdx] = sq; break;
-            }
+            addPiece(sq, pieceType | color);
             
             file++;
         }
@@ -114,6 +103,7 @@ void BitboardState::loadFromFEN(const std::string& fen) {
     setFiftyMoveCounter(gameState, halfmove);
     
     zobristKey = Zobrist::calculateZobristKey(*this);
+    pawnKey = Zobrist::calculatePawnKey(*this);
 }
 
 std::string BitboardState::toFEN() const {
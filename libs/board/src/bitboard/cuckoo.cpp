@@ -0,0 +1,117 @@
+#include <chess/board/bitboard/cuckoo.h>
+#include <chess/board/bitboard/zoborist.h>
+#include <chess/board/bitboard/precomputed_data.h>
+#include <chess/board/pieces/piece_const.h>
+#include <cassert>
+
+namespace chess {
+
+namespace {
+
+constexpr int CUCKOO_SIZE = 8192;
+constexpr int NUM_REVERSIBLE_MOVES = 3668;
+
+constexpr int cuckooH1(uint64_t key) { return static_cast<int>(key & (CUCKOO_SIZE - 1)); }
+constexpr int cuckooH2(uint64_t key) { return static_cast<int>((key >> 16) & (CUCKOO_SIZE - 1)); }
+
+struct CuckooTable {
+    uint64_t keys[CUCKOO_SIZE]{};
+    // start | target << 6, with start < target
+    uint16_t moves[CUCKOO_SIZE]{};
+    int count = 0;
+};
+
+// Whether a piece of the given type on an empty board moves from s1 to s2
+bool reaches(int pieceType, int s1, int s2) {
+    bool aligned = PrecomputedData::lineBitboards[s1][s2] != 0;
+    bool orthogonal = aligned && (s1 / 8 == s2 / 8 || s1 % 8 == s2 % 8);
+    switch (pieceType) {
+        case PIECE_KNIGHT: return (PrecomputedData::knightAttackBitboards[s1] >> s2) & 1;
+        case PIECE_KING:   return (PrecomputedData::kingAttackBitboards[s1] >> s2) & 1;
+        case PIECE_BISHOP: return aligned && !orthogonal;
+        case PIECE_ROOK:   return orthogonal;
+        case PIECE_QUEEN:  return aligned;
+        default:           return false;
+    }
+}
+
+// Filled once by initCuckoo(); building it as a constant expression costs
+// millions of evaluation steps, more than some compilers allow
+CuckooTable CUCKOO;
+
+} // namespace
+
+void initCuckoo() {
+    if (CUCKOO.count != 0) return;
+
+    constexpr int pieceTypes[5] = {PIECE_KNIGHT, PIECE_BISHOP, PIECE_ROOK, PIECE_QUEEN, PIECE_KING};
+    CuckooTable& table = CUCKOO;
+
+    for (int pieceType : pieceTypes) {
+        for (int color = 0; color < 2; ++color) {
+            for (int s1 = 0; s1 < 64; ++s1) {
+                for (int s2 = s1 + 1; s2 < 64; ++s2) {
+                    if (!reaches(pieceType, s1, s2)) {
+                        continue;
+                    }
+
+                    uint64_t key = Zobrist::piece(pieceType, color, s1) ^ Zobrist::piece(pieceType, color, s2) ^
+                                   Zobrist::sideToMove();
+                    uint16_t move = static_cast<uint16_t>(s1 | (s2 << 6));
+
+                    // Insert, evicting into the other slot of whatever was there
+                    int slot = cuckooH1(key);
+                    while (true) {
+                        uint64_t evictedKey = table.keys[slot];
+                        uint16_t evictedMove = table.moves[slot];
+                        table.keys[slot] = key;
+                        table.moves[slot] = move;
+                        if (evictedMove == 0) {
+                            break;
+                        }
+                        key = evictedKey;
+                        move = evictedMove;
+                        slot = slot == cuckooH1(key) ? cuckooH2(key) : cuckooH1(key);
+                    }
+                    table.count++;
+                }
+            }
+        }
+    }
+    assert(table.count == NUM_REVERSIBLE_MOVES && "unexpected number of reversible moves");
+}
+
+bool hasUpcomingRepetition(const BitboardState& state, const PositionHistory& history, int maxPlies) {
+    int n = maxPlies < history.size() ? maxPlies : history.size();
+    if (n > PositionHistory::CAPACITY) n = PositionHistory::CAPACITY;
+    int friendlyColour = state.whiteToMove ? COLOR_WHITE : COLOR_BLACK;
+
+    // Odd plies back the other side was to move, so one move of ours and
+    // the side-to-move toggle separate the two keys
+    for (int i = 3; i <= n; i += 2) {
+        uint64_t moveKey = state.zobristKey ^ history.keyAt(i);
+        int slot = cuckooH1(moveKey);
+        if (CUCKOO.keys[slot] != moveKey) {
+            slot = cuckooH2(moveKey);
+            if (CUCKOO.keys[slot] != moveKey) {
+                continue;
+            }
+        }
+
+        int s1 = CUCKOO.moves[slot] & 63;
+        int s2 = CUCKOO.moves[slot] >> 6;
+        if (PrecomputedData::betweenBitboards[s1][s2] & state.allPiecesBitboard) {
+            continue;
+        }
+
+        // The table stores each move once for both directions; the piece
+        // stands on whichever end is occupied and must be ours to move
+        int piece = state.square[s1] != PIECE_NONE ? state.square[s1] : state.square[s2];
+        if (isColor(piece, friendlyColour)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace chess
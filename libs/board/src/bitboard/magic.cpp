@@ -0,0 +1,174 @@
+#include <chess/board/bitboard/magic.h>
+#include <chess/board/bitboard/bitboard.h>
+
+#if CHESS_HAS_PEXT
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace chess {
+
+Magic::MagicEntry Magic::rookMagics[64] = {};
+Magic::MagicEntry Magic::bishopMagics[64] = {};
+uint64_t Magic::rookTable[ROOK_TABLE_SIZE] = {};
+uint64_t Magic::bishopTable[BISHOP_TABLE_SIZE] = {};
+Magic::PextEntry Magic::rookPext[64] = {};
+Magic::PextEntry Magic::bishopPext[64] = {};
+uint64_t Magic::rookPextTable[ROOK_TABLE_SIZE] = {};
+uint64_t Magic::bishopPextTable[BISHOP_TABLE_SIZE] = {};
+bool Magic::hasPext = false;
+bool Magic::hasFastPext = false;
+bool Magic::initialized = false;
+
+namespace {
+
+// Found offline with a sparse xorshift64* search; every value maps all
+// relevant occupancies of its square into (1 << popcount(mask)) slots
+// without a destructive collision.
+constexpr uint64_t ROOK_MAGICS[64] = {
+    0x0A80004000801220ULL, 0x8040004010002008ULL, 0x2080200010008008ULL, 0x1100100008210004ULL,
+    0xC200209084020008ULL, 0x2100010004000208ULL, 0x0400081000822421ULL, 0x0200010422048844ULL,
+    0x0800800080400024ULL, 0x0001402000401000ULL, 0x3000801000802001ULL, 0x4400800800100083ULL,
+    0x0904802402480080ULL, 0x4040800400020080ULL, 0x0018808042000100ULL, 0x4040800080004100ULL,
+    0x0040048001458024ULL, 0x00A0004000205000ULL, 0x3100808010002000ULL, 0x4825010010000820ULL,
+    0x5004808008000401ULL, 0x2024818004000A00ULL, 0x0005808002000100ULL, 0x2100060004806104ULL,
+    0x0080400880008421ULL, 0x4062220600410280ULL, 0x010A004A00108022ULL, 0x0000100080080080ULL,
+    0x0021000500080010ULL, 0x0044000202001008ULL, 0x0000100400080102ULL, 0xC020128200040545ULL,
+    0x0080002000400040ULL, 0x0000804000802004ULL, 0x0000120022004080ULL, 0x010A386103001001ULL,
+    0x9010080080800400ULL, 0x8440020080800400ULL, 0x0004228824001001ULL, 0x000000490A000084ULL,
+    0x0080002000504000ULL, 0x200020005000C000ULL, 0x0012088020420010ULL, 0x0010010080080800ULL,
+    0x0085001008010004ULL, 0x0002000204008080ULL, 0x0040413002040008ULL, 0x0000304081020004ULL,
+    0x0080204000800080ULL, 0x3008804000290100ULL, 0x1010100080200080ULL, 0x2008100208028080ULL,
+    0x5000850800910100ULL, 0x8402019004680200ULL, 0x0120911028020400ULL, 0x0000008044010200ULL,
+    0x0020850200244012ULL, 0x0020850200244012ULL, 0x0000102001040841ULL, 0x140900040A100021ULL,
+    0x000200282410A102ULL, 0x000200282410A102ULL, 0x000200282410A102ULL, 0x4048240043802106ULL
+};
+
+constexpr uint64_t BISHOP_MAGICS[64] = {
+    0x40106000A1160020ULL, 0x0020010250810120ULL, 0x2010010220280081ULL, 0x002806004050C040ULL,
+    0x0002021018000000ULL, 0x2001112010000400ULL, 0x0881010120218080ULL, 0x1030820110010500ULL,
+    0x0000120222042400ULL, 0x2000020404040044ULL, 0x8000480094208000ULL, 0x0003422A02000001ULL,
+    0x000A220210100040ULL, 0x8004820202226000ULL, 0x0018234854100800ULL, 0x0100004042101040ULL,
+    0x0004001004082820ULL, 0x0010000810010048ULL, 0x1014004208081300ULL, 0x2080818802044202ULL,
+    0x0040880C00A00100ULL, 0x0080400200522010ULL, 0x0001000188180B04ULL, 0x0080249202020204ULL,
+    0x1004400004100410ULL, 0x00013100A0022206ULL, 0x2148500001040080ULL, 0x4241080011004300ULL,
+    0x4020848004002000ULL, 0x10101380D1004100ULL, 0x0008004422020284ULL, 0x01010A1041008080ULL,
+    0x0808080400082121ULL, 0x0808080400082121ULL, 0x0091128200100C00ULL, 0x0202200802010104ULL,
+    0x8C0A020200440085ULL, 0x01A0008080B10040ULL, 0x0889520080122800ULL, 0x100902022202010AULL,
+    0x04081A0816002000ULL, 0x0000681208005000ULL, 0x8170840041008802ULL, 0x0A00004200810805ULL,
+    0x0830404408210100ULL, 0x2602208106006102ULL, 0x1048300680802628ULL, 0x2602208106006102ULL,
+    0x0602010120110040ULL, 0x0941010801043000ULL, 0x000040440A210428ULL, 0x0008240020880021ULL,
+    0x0400002012048200ULL, 0x00AC102001210220ULL, 0x0220021002009900ULL, 0x84440C080A013080ULL,
+    0x0001008044200440ULL, 0x0004C04410841000ULL, 0x2000500104011130ULL, 0x1A0C010011C20229ULL,
+    0x0044800112202200ULL, 0x0434804908100424ULL, 0x0300404822C08200ULL, 0x48081010008A2A80ULL
+};
+
+} // namespace
+
+uint64_t Magic::slidingAttacks(int square, uint64_t occupancy, bool orthogonal) {
+    static constexpr int rookDirs[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    static constexpr int bishopDirs[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    const int (*dirs)[2] = orthogonal ? rookDirs : bishopDirs;
+
+    uint64_t attacks = 0ULL;
+    int rank = square / 8;
+    int file = square % 8;
+
+    for (int d = 0; d < 4; ++d) {
+        int r = rank + dirs[d][0];
+        int f = file + dirs[d][1];
+        while (r >= 0 && r < 8 && f >= 0 && f < 8) {
+            int target = r * 8 + f;
+            attacks |= bit(target);
+            if (getBit(occupancy, target)) break;
+            r += dirs[d][0];
+            f += dirs[d][1];
+        }
+    }
+    return attacks;
+}
+
+void Magic::initSlider(MagicEntry* magics, const uint64_t* magicNumbers, uint64_t* table,
+                       PextEntry* pext, uint64_t* pextTable, bool orthogonal) {
+    uint64_t* next = table;
+    uint64_t* nextPext = pextTable;
+
+    for (int square = 0; square < 64; ++square) {
+        int rank = square / 8;
+        int file = square % 8;
+
+        // Edge squares never change the attack set, so they are left out of the mask
+        uint64_t edges = ((0x00000000000000FFULL | 0xFF00000000000000ULL) & ~(0xFFULL << (rank * 8))) |
+                         ((0x0101010101010101ULL | 0x8080808080808080ULL) & ~(0x0101010101010101ULL << file));
+
+        MagicEntry& m = magics[square];
+        m.mask = slidingAttacks(square, 0ULL, orthogonal) & ~edges;
+        m.magic = magicNumbers[square];
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = next;
+
+        PextEntry& p = pext[square];
+        p.mask = m.mask;
+        p.attacks = nextPext;
+
+        // Carry-Rippler enumeration of every subset of the mask. Subsets come
+        // out in increasing order of their packed bits, so the running count
+        // is exactly the PEXT index and the table can be filled without BMI2.
+        int size = 0;
+        uint64_t occ = 0ULL;
+        do {
+            uint64_t attacks = slidingAttacks(square, occ, orthogonal);
+            m.attacks[(occ * m.magic) >> m.shift] = attacks;
+            p.attacks[size] = attacks;
+            size++;
+            occ = (occ - m.mask) & m.mask;
+        } while (occ);
+
+        next += size;
+        nextPext += size;
+    }
+}
+
+void Magic::detectPext() {
+#if CHESS_HAS_PEXT
+    unsigned int vendorEbx = 0, versionEax = 0, featureEbx = 0;
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return;
+    vendorEbx = static_cast<unsigned int>(info[1]);
+    __cpuid(info, 1);
+    versionEax = static_cast<unsigned int>(info[0]);
+    __cpuidex(info, 7, 0);
+    featureEbx = static_cast<unsigned int>(info[1]);
+#else
+    unsigned int maxLeaf, eax, ecx, edx;
+    if (!__get_cpuid(0, &maxLeaf, &vendorEbx, &ecx, &edx) || maxLeaf < 7) return;
+    __get_cpuid(1, &versionEax, &featureEbx, &ecx, &edx);
+    __cpuid_count(7, 0, eax, featureEbx, ecx, edx);
+#endif
+    hasPext = (featureEbx >> 8) & 1; // CPUID.(EAX=7,ECX=0):EBX.BMI2
+
+    // Zen 1 and Zen 2 (family 17h) implement PEXT in microcode, which is
+    // far slower than a magic multiply
+    bool amd = vendorEbx == 0x68747541; // "Auth" of "AuthenticAMD"
+    unsigned int family = (versionEax >> 8) & 0xF;
+    if (family == 0xF) family += (versionEax >> 20) & 0xFF;
+    hasFastPext = hasPext && !(amd && family < 0x19);
+#endif
+}
+
+void Magic::init() {
+    if (initialized) return;
+
+    initSlider(rookMagics, ROOK_MAGICS, rookTable, rookPext, rookPextTable, true);
+    initSlider(bishopMagics, BISHOP_MAGICS, bishopTable, bishopPext, bishopPextTable, false);
+    detectPext();
+
+    initialized = true;
+}
+
+} // namespace chess
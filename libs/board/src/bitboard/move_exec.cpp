@@ -6,10 +6,73 @@
 
 namespace chess {
 
-UndoState BBMoveExecutor::makeMove(const BBMove& move) {    
+UndoState BBMoveExecutor::makeMove(const BBMove& move) {
+    return state.whiteToMove ? makeMove<WHITE>(move) : makeMove<BLACK>(move);
+}
+
+void BBMoveExecutor::unmakeMove(const BBMove& move, const UndoState& undo) {
+    // whiteToMove still names the opponent of the side that made the move
+    if (state.whiteToMove) {
+        unmakeMove<BLACK>(move, undo);
+    } else {
+        unmakeMove<WHITE>(move, undo);
+    }
+}
+
+UndoState BBMoveExecutor::makeNullMove() {
+    if (history) {
+        history->push(state.zobristKey);
+    }
+    
     UndoState undo;
     undo.previousGameState = state.gameState;
     undo.previousZobrist = state.zobristKey;
+    undo.previousPawnKey = state.pawnKey;
+    undo.previousFiftyMove = state.fiftyMoveCounter;
+    undo.previousPlyCount = state.plyCount;
+    undo.capturedPiece = PIECE_NONE;
+    
+    int oldEP = getEPFile(state.gameState);
+    if (oldEP >= 0) {
+        state.zobristKey ^= Zobrist::enPassantFile(oldEP);
+        setEPFile(state.gameState, -1);
+    }
+    
+    state.whiteToMove = !state.whiteToMove;
+    state.zobristKey ^= Zobrist::sideToMove();
+    state.plyCount++;
+    state.fiftyMoveCounter = 0;
+    
+    return undo;
+}
+
+void BBMoveExecutor::unmakeNullMove(const UndoState& undo) {
+    state.whiteToMove = !state.whiteToMove;
+    state.gameState = undo.previousGameState;
+    state.zobristKey = undo.previousZobrist;
+    state.pawnKey = undo.previousPawnKey;
+    state.fiftyMoveCounter = undo.previousFiftyMove;
+    state.plyCount = undo.previousPlyCount;
+    
+    if (history) {
+        history->pop();
+    }
+}
+
+template<Color Us>
+UndoState BBMoveExecutor::makeMove(const BBMove& move) {
+    constexpr int colorIdx = Us;
+    constexpr int opponentIdx = Us == WHITE ? BLACK : WHITE;
+    constexpr int friendlyColour = Us == WHITE ? COLOR_WHITE : COLOR_BLACK;
+    
+    if (history) {
+        history->push(state.zobristKey);
+    }
+    
+    UndoState undo;
+    undo.previousGameState = state.gameState;
+    undo.previousZobrist = state.zobristKey;
+    undo.previousPawnKey = state.pawnKey;
     undo.previousFiftyMove = state.fiftyMoveCounter;
     undo.previousPlyCount = state.plyCount;
     
@@ -17,21 +80,16 @@ UndoState BBMoveExecutor::makeMove(const BBMove& move) {
     int to = move.targetSquare();
     int movePiece = state.square[from];
     int movePieceType = typeOf(movePiece);
-    int colorIdx = isColor(movePiece, COLOR_WHITE) ? 0 : 1;
-    int opponentIdx = 1 - colorIdx;
     
     int capturedPiece = state.square[to];
     undo.capturedPiece = typeOf(capturedPiece);
     
     if (capturedPiece != PIECE_NONE && move.flag() != BBMove::EnPassantCapture) {
-        switch (undo.capturedPiece) {
-            case PIECE_PAWN:   state.pawns[opponentIdx].remove(to); break;
-            case PIECE_KNIGHT: state.knights[opponentIdx].remove(to); break;
-            case PIECE_BISHOP: state.bishops[opponentIdx].remove(to); break;
-            case PIECE_ROOK:   state.rooks[opponentIdx].remove(to); break;
-            case PIECE_QUEEN:  state.queens[opponentIdx].remove(to); break;
-        }
+        state.removePiece(to);
         state.zobristKey ^= Zobrist::piece(undo.capturedPiece, opponentIdx, to);
+        if (undo.capturedPiece == PIECE_PAWN) {
+            state.pawnKey ^= Zobrist::piece(PIECE_PAWN, opponentIdx, to);
+        }
     }
     
     int oldEP = getEPFile(state.gameState);
@@ -40,22 +98,14 @@ UndoState BBMoveExecutor::makeMove(const BBMove& move) {
     }
     
     state.zobristKey ^= Zobrist::piece(movePieceType, colorIdx, from);
-    if (movePieceType == PIECE_KING) {
-        state.kingSquare[colorIdx] = to;
-    } else {
-        switch (movePieceType) {
-            case PIECE_PAWN:   state.pawns[colorIdx].move(from, to); break;
-            case PIECE_KNIGHT: state.knights[colorIdx].move(from, to); break;
-            case PIECE_BISHOP: state.bishops[colorIdx].move(from, to); break;
-            case PIECE_ROOK:   state.rooks[colorIdx].move(from, to); break;
-            case PIECE_QUEEN:  state.queens[colorIdx].move(from, to); break;
-        }
+    state.movePiece(from, to);
+    if (movePieceType == PIECE_PAWN) {
+        state.pawnKey ^= Zobrist::piece(PIECE_PAWN, colorIdx, from);
     }
     
     int pieceOnTarget = movePiece;
     
     if (move.isPromotion()) {
-        state.pawns[colorIdx].remove(to);
         int promoteType = PIECE_QUEEN;
         switch (move.flag()) {
             case BBMove::PromoteToQueen:  promoteType = PIECE_QUEEN; break;
@@ -64,43 +114,33 @@ UndoState BBMoveExecutor::makeMove(const BBMove& move) {
             case BBMove::PromoteToKnight: promoteType = PIECE_KNIGHT; break;
             default: break;
         }
-        pieceOnTarget = promoteType | (colorIdx == 0 ? COLOR_WHITE : COLOR_BLACK);
-        
-        switch (promoteType) {
-            case PIECE_QUEEN:  state.queens[colorIdx].add(to); break;
-            case PIECE_ROOK:   state.rooks[colorIdx].add(to); break;
-            case PIECE_BISHOP: state.bishops[colorIdx].add(to); break;
-            case PIECE_KNIGHT: state.knights[colorIdx].add(to); break;
-        }
-        state.zobristKey ^= Zobrist::piece(PIECE_PAWN, colorIdx, from);
-        state.zobristKey ^= Zobrist::piece(promoteType, colorIdx, to);
+        pieceOnTarget = promoteType | friendlyColour;
+        state.removePiece(to);
+        state.addPiece(to, pieceOnTarget);
     } else if (move.flag() == BBMove::Castling) {
         int rookFrom, rookTo;
         if (to > from) {
-            rookFrom = colorIdx == 0 ? 7 : 63;
-            rookTo = colorIdx == 0 ? 5 : 61;
+            rookFrom = Us == WHITE ? 7 : 63;
+            rookTo = Us == WHITE ? 5 : 61;
         } else {
-            rookFrom = colorIdx == 0 ? 0 : 56;
-            rookTo = colorIdx == 0 ? 3 : 59;
+            rookFrom = Us == WHITE ? 0 : 56;
+            rookTo = Us == WHITE ? 3 : 59;
         }
-        int rook = state.square[rookFrom];
-        state.square[rookTo] = rook;
-        state.square[rookFrom] = PIECE_NONE;
-        state.rooks[colorIdx].move(rookFrom, rookTo);
+        state.movePiece(rookFrom, rookTo);
         state.zobristKey ^= Zobrist::piece(PIECE_ROOK, colorIdx, rookFrom);
         state.zobristKey ^= Zobrist::piece(PIECE_ROOK, colorIdx, rookTo);
     } else if (move.flag() == BBMove::EnPassantCapture) {
-        int capturedSq = colorIdx == 0 ? to - 8 : to + 8;
-        int capturedPawn = state.square[capturedSq];
+        int capturedSq = Us == WHITE ? to - 8 : to + 8;
         undo.capturedPiece = PIECE_PAWN;
-        state.square[capturedSq] = PIECE_NONE;
-        state.pawns[opponentIdx].remove(capturedSq);
+        state.removePiece(capturedSq);
         state.zobristKey ^= Zobrist::piece(PIECE_PAWN, opponentIdx, capturedSq);
+        state.pawnKey ^= Zobrist::piece(PIECE_PAWN, opponentIdx, capturedSq);
     }
     
-    state.square[to] = pieceOnTarget;
-    state.square[from] = PIECE_NONE;
     state.zobristKey ^= Zobrist::piece(typeOf(pieceOnTarget), colorIdx, to);
+    if (typeOf(pieceOnTarget) == PIECE_PAWN) {
+        state.pawnKey ^= Zobrist::piece(PIECE_PAWN, colorIdx, to);
+    }
     
     setEPFile(state.gameState, -1);
     if (move.flag() == BBMove::PawnTwoForward) {
@@ -111,7 +151,7 @@ UndoState BBMoveExecutor::makeMove(const BBMove& move) {
     
     uint32_t oldCastleRights = state.gameState & 15;
     if (movePieceType == PIECE_KING) {
-        state.gameState &= (colorIdx == 0 ? WHITE_CASTLE_MASK : BLACK_CASTLE_MASK);
+        state.gameState &= (Us == WHITE ? WHITE_CASTLE_MASK : BLACK_CASTLE_MASK);
     }
     if (from == 0 || to == 0) state.gameState &= ~CR_WHITE_Q;
     if (from == 7 || to == 7) state.gameState &= ~CR_WHITE_K;
@@ -130,98 +170,55 @@ UndoState BBMoveExecutor::makeMove(const BBMove& move) {
     state.plyCount++;
     if (movePieceType == PIECE_PAWN || capturedPiece != PIECE_NONE) {
         state.fiftyMoveCounter = 0;
-        state.repetitionHistory.clear();
     } else {
         state.fiftyMoveCounter++;
     }
     
-    if (!state.repetitionHistory.empty() && state.plyCount > 1) {
-        state.repetitionHistory.push_back(state.zobristKey);
-        state.zobristHistory.push_back(state.zobristKey);
-    }
-    
     return undo;
 }
 
+template<Color Us>
 void BBMoveExecutor::unmakeMove(const BBMove& move, const UndoState& undo) {
-    state.whiteToMove = !state.whiteToMove;
+    constexpr int friendlyColour = Us == WHITE ? COLOR_WHITE : COLOR_BLACK;
+    constexpr int opponentColour = Us == WHITE ? COLOR_BLACK : COLOR_WHITE;
+    
+    state.whiteToMove = Us == WHITE;
     
     int from = move.startSquare();
     int to = move.targetSquare();
-    int movedPiece = state.square[to];
-    int movedPieceType = typeOf(movedPiece);
-    int colorIdx = isColor(movedPiece, COLOR_WHITE) ? 0 : 1;
-    int opponentIdx = 1 - colorIdx;
     
     if (move.isPromotion()) {
-        int promoteType = movedPieceType;
-        switch (promoteType) {
-            case PIECE_QUEEN:  state.queens[colorIdx].remove(to); break;
-            case PIECE_ROOK:   state.rooks[colorIdx].remove(to); break;
-            case PIECE_BISHOP: state.bishops[colorIdx].remove(to); break;
-            case PIECE_KNIGHT: state.knights[colorIdx].remove(to); break;
-        }
-        state.pawns[colorIdx].add(from);
-        movedPieceType = PIECE_PAWN;
-        movedPiece = PIECE_PAWN | (colorIdx == 0 ? COLOR_WHITE : COLOR_BLACK);
-    } else if (move.flag() == BBMove::Castling) {
+        state.removePiece(to);
+        state.addPiece(from, PIECE_PAWN | friendlyColour);
+    } else {
+        state.movePiece(to, from);
+    }
+    
+    if (move.flag() == BBMove::Castling) {
         int rookFrom, rookTo;
         if (to > from) {
-            rookFrom = colorIdx == 0 ? 7 : 63;
-            rookTo = colorIdx == 0 ? 5 : 61;
+            rookFrom = Us == WHITE ? 7 : 63;
+            rookTo = Us == WHITE ? 5 : 61;
         } else {
-            rookFrom = colorIdx == 0 ? 0 : 56;
-            rookTo = colorIdx == 0 ? 3 : 59;
+            rookFrom = Us == WHITE ? 0 : 56;
+            rookTo = Us == WHITE ? 3 : 59;
         }
-        int rook = state.square[rookTo];
-        state.square[rookFrom] = rook;
-        state.square[rookTo] = PIECE_NONE;
-        state.rooks[colorIdx].move(rookTo, rookFrom);
+        state.movePiece(rookTo, rookFrom);
     } else if (move.flag() == BBMove::EnPassantCapture) {
-        int capturedSq = colorIdx == 0 ? to - 8 : to + 8;
-        int capturedPawn = PIECE_PAWN | (opponentIdx == 0 ? COLOR_WHITE : COLOR_BLACK);
-        state.square[capturedSq] = capturedPawn;
-        state.pawns[opponentIdx].add(capturedSq);
-    }
-    
-    state.square[from] = movedPiece;
-    state.square[to] = PIECE_NONE;
-    
-    if (movedPieceType == PIECE_KING) {
-        state.kingSquare[colorIdx] = from;
-    } else if (!move.isPromotion()) {
-        switch (movedPieceType) {
-            case PIECE_PAWN:   state.pawns[colorIdx].move(to, from); break;
-            case PIECE_KNIGHT: state.knights[colorIdx].move(to, from); break;
-            case PIECE_BISHOP: state.bishops[colorIdx].move(to, from); break;
-            case PIECE_ROOK:   state.rooks[colorIdx].move(to, from); break;
-            case PIECE_QUEEN:  state.queens[colorIdx].move(to, from); break;
-        }
-    }
-    
-    if (undo.capturedPiece != PIECE_NONE && move.flag() != BBMove::EnPassantCapture) {
-        int capturedPiece = undo.capturedPiece | (opponentIdx == 0 ? COLOR_WHITE : COLOR_BLACK);
-        state.square[to] = capturedPiece;
-        
-        switch (undo.capturedPiece) {
-            case PIECE_PAWN:   state.pawns[opponentIdx].add(to); break;
-            case PIECE_KNIGHT: state.knights[opponentIdx].add(to); break;
-            case PIECE_BISHOP: state.bishops[opponentIdx].add(to); break;
-            case PIECE_ROOK:   state.rooks[opponentIdx].add(to); break;
-            case PIECE_QUEEN:  state.queens[opponentIdx].add(to); break;
-        }
+        int capturedSq = Us == WHITE ? to - 8 : to + 8;
+        state.addPiece(capturedSq, PIECE_PAWN | opponentColour);
+    } else if (undo.capturedPiece != PIECE_NONE) {
+        state.addPiece(to, undo.capturedPiece | opponentColour);
     }
     
     state.gameState = undo.previousGameState;
     state.zobristKey = undo.previousZobrist;
+    state.pawnKey = undo.previousPawnKey;
     state.fiftyMoveCounter = undo.previousFiftyMove;
     state.plyCount = undo.previousPlyCount;
     
-    if (!state.repetitionHistory.empty()) {
-        state.repetitionHistory.pop_back();
-    }
-    if (!state.zobristHistory.empty()) {
-        state.zobristHistory.pop_back();
+    if (history) {
+        history->pop();
     }
 }
 
@@ -1,5 +1,6 @@
 #include <chess/board/bitboard/move_generator_bb.h>
 #include <chess/board/bitboard/precomputed_data.h>
+#include <chess/board/bitboard/magic.h>
 #include <chess/board/bitboard/bitboard.h>
 #include <chess/board/pieces/piece_const.h>
 #include <chess/board/bitboard/move.h>
@@ -7,145 +8,173 @@
 
 namespace chess {
 
+namespace {
+
+// Per-side constants for the Color-templated generation kernels
+template<Color Us>
+struct Side {
+    static constexpr int them = Us == WHITE ? BLACK : WHITE;
+    static constexpr int colour = Us == WHITE ? COLOR_WHITE : COLOR_BLACK;
+    static constexpr int opponentColour = Us == WHITE ? COLOR_BLACK : COLOR_WHITE;
+    static constexpr int pawnOffset = Us == WHITE ? 8 : -8;
+};
+
+} // namespace
+
+SliderBackend MoveGeneratorBB::sliderBackend = SliderBackend::Magic;
+bool MoveGeneratorBB::sliderBackendSelected = false;
+
 MoveGeneratorBB::MoveGeneratorBB() {
-    PrecomputedData::init();
+    selectSliderBackend();
 }
 
-std::vector<BBMove> MoveGeneratorBB::generateMoves(BitboardState& state, bool capturesOnly) {
+void MoveGeneratorBB::selectSliderBackend() {
+    Magic::init();
+    if (!sliderBackendSelected) {
+        sliderBackend = Magic::preferredBackend();
+        sliderBackendSelected = true;
+    }
+}
+
+SliderBackend MoveGeneratorBB::getSliderBackend() {
+    selectSliderBackend();
+    return sliderBackend;
+}
+
+bool MoveGeneratorBB::setSliderBackend(SliderBackend backend) {
+    selectSliderBackend();
+    if (backend == SliderBackend::Pext && !Magic::pextSupported()) {
+        return false;
+    }
+    sliderBackend = backend;
+    sliderBackendSelected = true;
+    return true;
+}
+
+void MoveGeneratorBB::generateMoves(BitboardState& state, MoveList& moveList, bool capturesOnly) {
+    generateMoves(state, moveList, capturesOnly ? GenType::Captures : GenType::All);
+}
+
+void MoveGeneratorBB::generateMoves(BitboardState& state, MoveList& moveList, GenType type) {
     this->board = &state;
-    this->genQuiets = !capturesOnly;
-    this->moves.clear();
-    this->moves.reserve(capturesOnly ? 32 : 218);
+    this->genQuiets = type != GenType::Captures;
+    this->genCaptures = type != GenType::Quiets;
+    this->moves = &moveList;
+    moveList.clear();
     
     init();
-    calculateAttackData();
-    generateKingMoves();
+#if CHESS_HAS_PEXT
+    if (sliderBackend == SliderBackend::Pext) {
+        generateWithPext();
+        return;
+    }
+#endif
+    generateWithMagic();
+}
+
+std::vector<BBMove> MoveGeneratorBB::generateMoves(BitboardState& state, bool capturesOnly) {
+    MoveList moveList;
+    generateMoves(state, moveList, capturesOnly);
+    return std::vector<BBMove>(moveList.begin(), moveList.end());
+}
+
+template<Color Us, typename Sliders>
+void MoveGeneratorBB::generate() {
+    calculateAttackData<Us, Sliders>();
+    generateKingMoves<Us>();
     
     if (inDoubleCheck) {
-        return moves;
+        return;
     }
     
-    generateSlidingMoves();
-    generateKnightMoves();
-    generatePawnMoves();
-    
-    return moves;
+    generateSlidingMoves<Us, Sliders>();
+    generateKnightMoves<Us>();
+    generatePawnMoves<Us, Sliders>();
+}
+
+// The side to move is the only runtime branch on colour; everything below
+// the entry points is instantiated once per side
+void MoveGeneratorBB::generateWithMagic() {
+    if (board->whiteToMove) {
+        generate<WHITE, MagicSliders>();
+    } else {
+        generate<BLACK, MagicSliders>();
+    }
 }
 
+#if CHESS_HAS_PEXT
+// Everything below is inlined into this one BMI2 function, so PEXT never
+// leaks into code that runs on older CPUs
+CHESS_TARGET_BMI2 CHESS_FLATTEN void MoveGeneratorBB::generateWithPext() {
+    if (board->whiteToMove) {
+        generate<WHITE, PextSliders>();
+    } else {
+        generate<BLACK, PextSliders>();
+    }
+}
+#endif
+
 void MoveGeneratorBB::init() {
     inCheck = false;
     inDoubleCheck = false;
     pinsExistInPosition = false;
     checkRayBitmask = 0;
     pinRayBitmask = 0;
-    
-    isWhiteToMove = board->whiteToMove;
-    friendlyColour = board->whiteToMove ? COLOR_WHITE : COLOR_BLACK;
-    opponentColour = board->whiteToMove ? COLOR_BLACK : COLOR_WHITE;
-    friendlyKingSquare = board->kingSquare[board->whiteToMove ? 0 : 1];
-    friendlyColourIndex = board->whiteToMove ? 0 : 1;
-    opponentColourIndex = 1 - friendlyColourIndex;
+    friendlyKingSquare = board->kingSquare[board->whiteToMove ? WHITE : BLACK];
 }
 
+template<Color Us, typename Sliders>
 void MoveGeneratorBB::genSlidingAttackMap() {
+    constexpr int opponentColourIndex = Side<Us>::them;
+
     opponentSlidingAttackMap = 0;
     
-    for (int i = 0; i < board->rooks[opponentColourIndex].count(); i++) {
-        updateSlidingAttackPiece(board->rooks[opponentColourIndex].squares[i], 0, 4);
-    }
+    // Slide through the friendly king so squares behind it count as attacked
+    uint64_t occupancy = board->allPiecesBitboard & ~bit(friendlyKingSquare);
     
-    for (int i = 0; i < board->queens[opponentColourIndex].count(); i++) {
-        updateSlidingAttackPiece(board->queens[opponentColourIndex].squares[i], 0, 8);
+    uint64_t orthogonal = board->orthogonalSliders(opponentColourIndex);
+    while (orthogonal) {
+        opponentSlidingAttackMap |= Sliders::rook(popLSB(orthogonal), occupancy);
     }
     
-    for (int i = 0; i < board->bishops[opponentColourIndex].count(); i++) {
-        updateSlidingAttackPiece(board->bishops[opponentColourIndex].squares[i], 4, 8);
-    }
-}
-
-void MoveGeneratorBB::updateSlidingAttackPiece(int startSquare, int startDirIndex, int endDirIndex) {
-    for (int directionIndex = startDirIndex; directionIndex < endDirIndex; directionIndex++) {
-        int currentDirOffset = PrecomputedData::directionOffsets[directionIndex];
-        for (int n = 0; n < PrecomputedData::numSquaresToEdge[startSquare][directionIndex]; n++) {
-            int targetSquare = startSquare + currentDirOffset * (n + 1);
-            int targetSquarePiece = board->square[targetSquare];
-            opponentSlidingAttackMap |= (1ULL << targetSquare);
-            if (targetSquare != friendlyKingSquare) {
-                if (targetSquarePiece != PIECE_NONE) {
-                    break;
-                }
-            }
-        }
+    uint64_t diagonal = board->diagonalSliders(opponentColourIndex);
+    while (diagonal) {
+        opponentSlidingAttackMap |= Sliders::bishop(popLSB(diagonal), occupancy);
     }
 }
 
+template<Color Us, typename Sliders>
 void MoveGeneratorBB::calculateAttackData() {
-    genSlidingAttackMap();
+    constexpr int opponentColourIndex = Side<Us>::them;
+    genSlidingAttackMap<Us, Sliders>();
     
-    int startDirIndex = 0;
-    int endDirIndex = 8;
-    
-    if (board->queens[opponentColourIndex].count() == 0) {
-        startDirIndex = (board->rooks[opponentColourIndex].count() > 0) ? 0 : 4;
-        endDirIndex = (board->bishops[opponentColourIndex].count() > 0) ? 8 : 4;
-    }
+    // Enemy sliders that would see the king if friendly pieces were removed
+    uint64_t enemyPieces = board->colorBitboards[opponentColourIndex];
+    uint64_t snipers = (Sliders::rook(friendlyKingSquare, enemyPieces) & board->orthogonalSliders(opponentColourIndex)) |
+                       (Sliders::bishop(friendlyKingSquare, enemyPieces) & board->diagonalSliders(opponentColourIndex));
     
-    for (int dir = startDirIndex; dir < endDirIndex; dir++) {
-        bool isDiagonal = dir > 3;
+    while (snipers) {
+        int sniperSquare = popLSB(snipers);
+        uint64_t between = PrecomputedData::betweenBitboards[friendlyKingSquare][sniperSquare];
+        uint64_t blockers = between & board->allPiecesBitboard;
+        uint64_t rayMask = between | bit(sniperSquare);
         
-        int n = PrecomputedData::numSquaresToEdge[friendlyKingSquare][dir];
-        int directionOffset = PrecomputedData::directionOffsets[dir];
-        bool isFriendlyPieceAlongRay = false;
-        uint64_t rayMask = 0;
-        
-        for (int i = 0; i < n; i++) {
-            int squareIndex = friendlyKingSquare + directionOffset * (i + 1);
-            rayMask |= (1ULL << squareIndex);
-            int piece = board->square[squareIndex];
-            
-            // This square contains a piece
-            if (piece != PIECE_NONE) {
-                if (isColor(piece, friendlyColour)) {
-                    if (!isFriendlyPieceAlongRay) {
-                        isFriendlyPieceAlongRay = true;
-                    }
-                    else {
-                        break;
-                    }
-                }
-                else {
-                    int pieceType = typeOf(piece);
-                    
-                    if ((isDiagonal && (pieceType == PIECE_BISHOP || pieceType == PIECE_QUEEN)) ||
-                        (!isDiagonal && (pieceType == PIECE_ROOK || pieceType == PIECE_QUEEN))) {
-                        
-                        if (isFriendlyPieceAlongRay) {
-                            pinsExistInPosition = true;
-                            pinRayBitmask |= rayMask;
-                        }
-                        else {
-                            checkRayBitmask |= rayMask;
-                            inDoubleCheck = inCheck;
-                            inCheck = true;
-                        }
-                        break;
-                    } else {
-                        break;
-                    }
-                }
-            }
-        }
-        
-        if (inDoubleCheck) {
-            break;
+        if (blockers == 0) {
+            checkRayBitmask |= rayMask;
+            inDoubleCheck = inCheck;
+            inCheck = true;
+        } else if ((blockers & (blockers - 1)) == 0) {
+            pinsExistInPosition = true;
+            pinRayBitmask |= rayMask;
         }
     }
     
     opponentKnightAttacks = 0;
     bool isKnightCheck = false;
     
-    for (int i = 0; i < board->knights[opponentColourIndex].count(); i++) {
-        int startSquare = board->knights[opponentColourIndex].squares[i];
+    uint64_t knights = board->pieces(opponentColourIndex, PIECE_KNIGHT);
+    while (knights) {
+        int startSquare = popLSB(knights);
         opponentKnightAttacks |= PrecomputedData::knightAttackBitboards[startSquare];
         
         if (!isKnightCheck && getBit(opponentKnightAttacks, friendlyKingSquare)) {
@@ -159,8 +188,9 @@ void MoveGeneratorBB::calculateAttackData() {
     opponentPawnAttackMap = 0;
     bool isPawnCheck = false;
     
-    for (int i = 0; i < board->pawns[opponentColourIndex].count(); i++) {
-        int pawnSquare = board->pawns[opponentColourIndex].squares[i];
+    uint64_t pawns = board->pieces(opponentColourIndex, PIECE_PAWN);
+    while (pawns) {
+        int pawnSquare = popLSB(pawns);
         uint64_t pawnAttacks = PrecomputedData::pawnAttackBitboards[pawnSquare][opponentColourIndex];
         opponentPawnAttackMap |= pawnAttacks;
         
@@ -180,8 +210,12 @@ void MoveGeneratorBB::calculateAttackData() {
 }
 
 
+template<Color Us>
 void MoveGeneratorBB::generateKingMoves() {
-    const int* kingMoves = PrecomputedData::kingMoves[friendlyKingSquare];
+    constexpr int friendlyColour = Side<Us>::colour;
+    constexpr int opponentColour = Side<Us>::opponentColour;
+    
+    const int* kingMoves = PrecomputedData::kingMoves[friendlyKingSquare].data();
     int numMoves = PrecomputedData::numKingMoves[friendlyKingSquare];
     
     for (int i = 0; i < numMoves; i++) {
@@ -193,35 +227,37 @@ void MoveGeneratorBB::generateKingMoves() {
         }
         
         bool isCapture = isColor(pieceOnTargetSquare, opponentColour);
-        if (!isCapture) {
-            if (!genQuiets || squareIsInCheckRay(targetSquare)) {
+        if (isCapture) {
+            if (!genCaptures) {
                 continue;
             }
+        } else if (!genQuiets || squareIsInCheckRay(targetSquare)) {
+            continue;
         }
         
         if (!squareIsAttacked(targetSquare)) {
-            moves.emplace_back(friendlyKingSquare, targetSquare);
+            moves->emplace_back(friendlyKingSquare, targetSquare);
             
             if (!inCheck && !isCapture) {
-                int f_square = isWhiteToMove ? 5 : 61;
+                constexpr int f_square = Us == WHITE ? 5 : 61;
                 
-                if (targetSquare == f_square && hasKingsideCastleRight()) {
+                if (targetSquare == f_square && hasKingsideCastleRight<Us>()) {
                     int castleKingsideSquare = targetSquare + 1;
                     if (board->square[castleKingsideSquare] == PIECE_NONE) {
                         if (!squareIsAttacked(castleKingsideSquare)) {
-                            moves.emplace_back(friendlyKingSquare, castleKingsideSquare, BBMove::Castling);
+                            moves->emplace_back(friendlyKingSquare, castleKingsideSquare, BBMove::Castling);
                         }
                     }
                 }
                 
-                int d_square = isWhiteToMove ? 3 : 59;
+                constexpr int d_square = Us == WHITE ? 3 : 59;
 
-                if (targetSquare == d_square && hasQueensideCastleRight()) {
+                if (targetSquare == d_square && hasQueensideCastleRight<Us>()) {
                     int castleQueensideSquare = targetSquare - 1;
                     if (board->square[castleQueensideSquare] == PIECE_NONE && 
                         board->square[castleQueensideSquare - 1] == PIECE_NONE) {
                         if (!squareIsAttacked(castleQueensideSquare)) {
-                            moves.emplace_back(friendlyKingSquare, castleQueensideSquare, BBMove::Castling);
+                            moves->emplace_back(friendlyKingSquare, castleQueensideSquare, BBMove::Castling);
                         }
                     }
                 }
@@ -230,168 +266,171 @@ void MoveGeneratorBB::generateKingMoves() {
     }
 }
 
+template<Color Us, typename Sliders>
 void MoveGeneratorBB::generateSlidingMoves() {
-    for (int i = 0; i < board->rooks[friendlyColourIndex].count(); i++) {
-        generateSlidingPieceMoves(board->rooks[friendlyColourIndex].squares[i], 0, 4);
-    }
+    constexpr int friendlyColourIndex = Us;
+    uint64_t occupancy = board->allPiecesBitboard;
     
-    for (int i = 0; i < board->bishops[friendlyColourIndex].count(); i++) {
-        generateSlidingPieceMoves(board->bishops[friendlyColourIndex].squares[i], 4, 8);
+    uint64_t orthogonal = board->orthogonalSliders(friendlyColourIndex);
+    while (orthogonal) {
+        int startSquare = popLSB(orthogonal);
+        generateSlidingPieceMoves<Us>(startSquare, Sliders::rook(startSquare, occupancy));
     }
     
-    for (int i = 0; i < board->queens[friendlyColourIndex].count(); i++) {
-        generateSlidingPieceMoves(board->queens[friendlyColourIndex].squares[i], 0, 8);
+    uint64_t diagonal = board->diagonalSliders(friendlyColourIndex);
+    while (diagonal) {
+        int startSquare = popLSB(diagonal);
+        generateSlidingPieceMoves<Us>(startSquare, Sliders::bishop(startSquare, occupancy));
     }
 }
 
-void MoveGeneratorBB::generateSlidingPieceMoves(int startSquare, int startDirIndex, int endDirIndex) {
+template<Color Us>
+void MoveGeneratorBB::generateSlidingPieceMoves(int startSquare, uint64_t attacks) {
+    constexpr int friendlyColourIndex = Us;
+    constexpr int opponentColourIndex = Side<Us>::them;
     bool isPinned = isPinnedFunc(startSquare);
     
     if (inCheck && isPinned) {
         return;
     }
     
-    for (int directionIndex = startDirIndex; directionIndex < endDirIndex; directionIndex++) {
-        int currentDirOffset = PrecomputedData::directionOffsets[directionIndex];
-        
-        if (isPinned && !isMovingAlongRay(currentDirOffset, friendlyKingSquare, startSquare)) {
-            continue;
-        }
-        
-        for (int n = 0; n < PrecomputedData::numSquaresToEdge[startSquare][directionIndex]; n++) {
-            int targetSquare = startSquare + currentDirOffset * (n + 1);
-            int targetSquarePiece = board->square[targetSquare];
-            
-            if (isColor(targetSquarePiece, friendlyColour)) {
-                break;
-            }
-            bool isCapture = targetSquarePiece != PIECE_NONE;
-            
-            bool movePreventsCheck = squareIsInCheckRay(targetSquare);
-            if (movePreventsCheck || !inCheck) {
-                if (genQuiets || isCapture) {
-                    moves.emplace_back(startSquare, targetSquare);
-                }
-            }
-            // If square not empty or blocks check, can't continue
-            if (isCapture || movePreventsCheck) {
-                break;
-            }
-        }
+    uint64_t targets = attacks & ~board->colorBitboards[friendlyColourIndex];
+    if (!genQuiets) {
+        targets &= board->colorBitboards[opponentColourIndex];
+    }
+    if (!genCaptures) {
+        targets &= ~board->colorBitboards[opponentColourIndex];
+    }
+    if (inCheck) {
+        targets &= checkRayBitmask;
+    }
+    if (isPinned) {
+        targets &= PrecomputedData::lineBitboards[friendlyKingSquare][startSquare];
+    }
+    
+    while (targets) {
+        moves->emplace_back(startSquare, popLSB(targets));
     }
 }
 
+template<Color Us>
 void MoveGeneratorBB::generateKnightMoves() {
-    for (int i = 0; i < board->knights[friendlyColourIndex].count(); i++) {
-        int startSquare = board->knights[friendlyColourIndex].squares[i];
+    constexpr int friendlyColourIndex = Us;
+    constexpr int friendlyColour = Side<Us>::colour;
+    constexpr int opponentColour = Side<Us>::opponentColour;
+    
+    uint64_t knights = board->pieces(friendlyColourIndex, PIECE_KNIGHT);
+    while (knights) {
+        int startSquare = popLSB(knights);
         
         if (isPinnedFunc(startSquare)) {
             continue;
         }
         
-        const int* knightMoves = PrecomputedData::knightMoves[startSquare];
+        const int* knightMoves = PrecomputedData::knightMoves[startSquare].data();
         int numMoves = PrecomputedData::numKnightMoves[startSquare];
         
         for (int j = 0; j < numMoves; j++) {
             int targetSquare = knightMoves[j];
             int targetSquarePiece = board->square[targetSquare];
             bool isCapture = isColor(targetSquarePiece, opponentColour);
-            if (genQuiets || isCapture) {
+            if (isCapture ? genCaptures : genQuiets) {
                 if (isColor(targetSquarePiece, friendlyColour) || 
                     (inCheck && !squareIsInCheckRay(targetSquare))) {
                     continue;
                 }
-                moves.emplace_back(startSquare, targetSquare);
+                moves->emplace_back(startSquare, targetSquare);
             }
         }
     }
 }
 
+template<Color Us, typename Sliders>
 void MoveGeneratorBB::generatePawnMoves() {
-    int pawnOffset = (friendlyColour == COLOR_WHITE) ? 8 : -8;
-    int startRank = isWhiteToMove ? 1 : 6;
-    int finalRankBeforePromotion = isWhiteToMove ? 6 : 1;
+    constexpr int friendlyColourIndex = Us;
+    constexpr int opponentColourIndex = Side<Us>::them;
+    constexpr int pawnOffset = Side<Us>::pawnOffset;
+    // Capture steps towards the a-file and the h-file
+    constexpr int captureWest = pawnOffset - 1;
+    constexpr int captureEast = pawnOffset + 1;
+    constexpr uint64_t promotionRank = Us == WHITE ? RANK_8 : RANK_1;
+    constexpr uint64_t doublePushRank = Us == WHITE ? RANK_4 : RANK_5;
+    
+    // All pawns move at once: shift the pawn set and mask the result. Pins
+    // are the only per-pawn condition and are checked while serializing.
+    uint64_t pawns = board->pieces(friendlyColourIndex, PIECE_PAWN);
+    uint64_t checkMask = inCheck ? checkRayBitmask : ~0ULL;
+    
+    if (genQuiets) {
+        uint64_t empty = ~board->allPiecesBitboard;
+        uint64_t singlePushes = shift<pawnOffset>(pawns) & empty;
+        uint64_t doublePushes = shift<pawnOffset>(singlePushes) & empty & doublePushRank & checkMask;
+        singlePushes &= checkMask;
+        
+        serializePawnMoves<pawnOffset>(singlePushes & ~promotionRank, BBMove::None);
+        serializePawnMoves<2 * pawnOffset>(doublePushes, BBMove::PawnTwoForward);
+        serializePromotions<pawnOffset>(singlePushes & promotionRank);
+    }
+    
+    if (!genCaptures) {
+        return;
+    }
+    
+    uint64_t enemies = board->colorBitboards[opponentColourIndex] & checkMask;
+    uint64_t westCaptures = shift<captureWest>(pawns) & enemies;
+    uint64_t eastCaptures = shift<captureEast>(pawns) & enemies;
+    
+    serializePawnMoves<captureWest>(westCaptures & ~promotionRank, BBMove::None);
+    serializePawnMoves<captureEast>(eastCaptures & ~promotionRank, BBMove::None);
+    serializePromotions<captureWest>(westCaptures & promotionRank);
+    serializePromotions<captureEast>(eastCaptures & promotionRank);
     
     int enPassantFile = ((board->gameState >> 4) & 15) - 1;
-    int enPassantSquare = -1;
-    if (enPassantFile != -1) {
-        enPassantSquare = 8 * (isWhiteToMove ? 5 : 2) + enPassantFile;
+    if (enPassantFile == -1) {
+        return;
     }
     
-    for (int i = 0; i < board->pawns[friendlyColourIndex].count(); i++) {
-        int startSquare = board->pawns[friendlyColourIndex].squares[i];
-        int rank = startSquare / 8;
-        bool oneStepFromPromotion = rank == finalRankBeforePromotion;
-        
-        if (genQuiets) {
-            int squareOneForward = startSquare + pawnOffset;
-            
-            if (board->square[squareOneForward] == PIECE_NONE) {
-                if (!isPinnedFunc(startSquare) || isMovingAlongRay(pawnOffset, startSquare, friendlyKingSquare)) {
-                    if (!inCheck || squareIsInCheckRay(squareOneForward)) {
-                        if (oneStepFromPromotion) {
-                            makePromotionMoves(startSquare, squareOneForward);
-                        } else {
-                            moves.emplace_back(startSquare, squareOneForward);
-                        }
-                    }
-                    
-                    if (rank == startRank) {
-                        int squareTwoForward = squareOneForward + pawnOffset;
-                        if (board->square[squareTwoForward] == PIECE_NONE) {
-                            if (!inCheck || squareIsInCheckRay(squareTwoForward)) {
-                                moves.emplace_back(startSquare, squareTwoForward, BBMove::PawnTwoForward);
-                            }
-                        }
-                    }
-                }
-            }
+    // En passant skips the check mask: inCheckAfterEnPassant looks at the
+    // whole position after the capture, which also covers pins and a
+    // capture of the checking pawn
+    int enPassantSquare = 8 * (Us == WHITE ? 5 : 2) + enPassantFile;
+    int epCapturedPawnSquare = enPassantSquare - pawnOffset;
+    uint64_t epAttackers = pawns & PrecomputedData::pawnAttackBitboards[enPassantSquare][opponentColourIndex];
+    while (epAttackers) {
+        int startSquare = popLSB(epAttackers);
+        if (!inCheckAfterEnPassant<Us, Sliders>(startSquare, enPassantSquare, epCapturedPawnSquare)) {
+            moves->emplace_back(startSquare, enPassantSquare, BBMove::EnPassantCapture);
         }
-        
-        for (int j = 0; j < 2; j++) {
-            int* pawnAttackDirs = PrecomputedData::pawnAttackDirections[friendlyColourIndex];
-            if (PrecomputedData::numSquaresToEdge[startSquare][pawnAttackDirs[j]] > 0) {
-                int pawnCaptureDir = PrecomputedData::directionOffsets[pawnAttackDirs[j]];
-                int targetSquare = startSquare + pawnCaptureDir;
-                int targetPiece = board->square[targetSquare];
-                
-                if (isPinnedFunc(startSquare) && !isMovingAlongRay(pawnCaptureDir, friendlyKingSquare, startSquare)) {
-                    continue;
-                }
-                
-                if (isColor(targetPiece, opponentColour)) {
-                    if (inCheck && !squareIsInCheckRay(targetSquare)) {
-                        continue;
-                    }
-                    if (oneStepFromPromotion) {
-                        makePromotionMoves(startSquare, targetSquare);
-                    } else {
-                        moves.emplace_back(startSquare, targetSquare);
-                    }
-                }
-                
-                // En passant requires special check for revealed check
-                if (targetSquare == enPassantSquare) {
-                    int epCapturedPawnSquare = targetSquare + (isWhiteToMove ? -8 : 8);
-                    if (!inCheckAfterEnPassant(startSquare, targetSquare, epCapturedPawnSquare)) {
-                        moves.emplace_back(startSquare, targetSquare, BBMove::EnPassantCapture);
-                    }
-                }
-            }
+    }
+}
+
+template<int Offset>
+void MoveGeneratorBB::serializePawnMoves(uint64_t targets, BBMove::Flag flag) {
+    while (targets) {
+        int targetSquare = popLSB(targets);
+        int startSquare = targetSquare - Offset;
+        if (!isPinnedFunc(startSquare) || getBit(PrecomputedData::lineBitboards[friendlyKingSquare][startSquare], targetSquare)) {
+            moves->emplace_back(startSquare, targetSquare, flag);
         }
     }
 }
 
-void MoveGeneratorBB::makePromotionMoves(int fromSquare, int toSquare) {
-    moves.emplace_back(fromSquare, toSquare, BBMove::PromoteToQueen);
-    moves.emplace_back(fromSquare, toSquare, BBMove::PromoteToKnight);
-    moves.emplace_back(fromSquare, toSquare, BBMove::PromoteToRook);
-    moves.emplace_back(fromSquare, toSquare, BBMove::PromoteToBishop);
+template<int Offset>
+void MoveGeneratorBB::serializePromotions(uint64_t targets) {
+    while (targets) {
+        int targetSquare = popLSB(targets);
+        int startSquare = targetSquare - Offset;
+        if (!isPinnedFunc(startSquare) || getBit(PrecomputedData::lineBitboards[friendlyKingSquare][startSquare], targetSquare)) {
+            makePromotionMoves(startSquare, targetSquare);
+        }
+    }
 }
 
-bool MoveGeneratorBB::isMovingAlongRay(int rayDir, int startSquare, int targetSquare) {
-    int moveDir = PrecomputedData::directionLookup[targetSquare - startSquare + 63];
-    return (rayDir == moveDir || -rayDir == moveDir);
+void MoveGeneratorBB::makePromotionMoves(int fromSquare, int toSquare) {
+    moves->emplace_back(fromSquare, toSquare, BBMove::PromoteToQueen);
+    moves->emplace_back(fromSquare, toSquare, BBMove::PromoteToKnight);
+    moves->emplace_back(fromSquare, toSquare, BBMove::PromoteToRook);
+    moves->emplace_back(fromSquare, toSquare, BBMove::PromoteToBishop);
 }
 
 bool MoveGeneratorBB::isPinnedFunc(int square) {
@@ -402,13 +441,15 @@ bool MoveGeneratorBB::squareIsInCheckRay(int square) {
     return inCheck && ((checkRayBitmask >> square) & 1) != 0;
 }
 
+template<Color Us>
 bool MoveGeneratorBB::hasKingsideCastleRight() {
-    int mask = isWhiteToMove ? 1 : 4;
+    constexpr int mask = Us == WHITE ? 1 : 4;
     return (board->gameState & mask) != 0;
 }
 
+template<Color Us>
 bool MoveGeneratorBB::hasQueensideCastleRight() {
-    int mask = isWhiteToMove ? 2 : 8;
+    constexpr int mask = Us == WHITE ? 2 : 8;
     return (board->gameState & mask) != 0;
 }
 
@@ -416,57 +457,167 @@ bool MoveGeneratorBB::squareIsAttacked(int square) {
     return getBit(opponentAttackMap, square);
 }
 
+template<Color Us, typename Sliders>
 bool MoveGeneratorBB::inCheckAfterEnPassant(int startSquare, int targetSquare, int epCapturedPawnSquare) {
-    board->square[targetSquare] = board->square[startSquare];
-    board->square[startSquare] = PIECE_NONE;
-    board->square[epCapturedPawnSquare] = PIECE_NONE;
+    constexpr int friendlyColourIndex = Us;
+    constexpr int opponentColourIndex = Side<Us>::them;
+    // Both pawns leave their squares at once, which can expose the king along a rank
+    uint64_t occupancy = (board->allPiecesBitboard ^ bit(startSquare) ^ bit(epCapturedPawnSquare)) | bit(targetSquare);
     
-    bool inCheckAfterEpCapture = false;
-    if (squareAttackedAfterEPCapture(epCapturedPawnSquare, startSquare)) {
-        inCheckAfterEpCapture = true;
+    if (Sliders::rook(friendlyKingSquare, occupancy) & board->orthogonalSliders(opponentColourIndex)) {
+        return true;
+    }
+    if (Sliders::bishop(friendlyKingSquare, occupancy) & board->diagonalSliders(opponentColourIndex)) {
+        return true;
+    }
+    if (PrecomputedData::knightAttackBitboards[friendlyKingSquare] & board->pieces(opponentColourIndex, PIECE_KNIGHT)) {
+        return true;
     }
     
-    board->square[targetSquare] = PIECE_NONE;
-    board->square[startSquare] = PIECE_PAWN | friendlyColour;
-    board->square[epCapturedPawnSquare] = PIECE_PAWN | opponentColour;
-    return inCheckAfterEpCapture;
+    uint64_t enemyPawns = board->pieces(opponentColourIndex, PIECE_PAWN) & ~bit(epCapturedPawnSquare);
+    return (PrecomputedData::pawnAttackBitboards[friendlyKingSquare][friendlyColourIndex] & enemyPawns) != 0;
 }
 
-bool MoveGeneratorBB::squareAttackedAfterEPCapture(int epCaptureSquare, int capturingPawnStartSquare) {
-    if (getBit(opponentAttackMapNoPawns, friendlyKingSquare)) {
+namespace {
+
+// True if any piece of colour `by` outside `captured` attacks square, with
+// sliders looking through the given occupancy
+bool isAttackedBy(const BitboardState& state, int square, int by, uint64_t occupancy, uint64_t captured) {
+    int defender = by ^ 1;
+    uint64_t keep = ~captured;
+    
+    if (PrecomputedData::pawnAttackBitboards[square][defender] & state.pieces(by, PIECE_PAWN) & keep) {
+        return true;
+    }
+    if (PrecomputedData::knightAttackBitboards[square] & state.pieces(by, PIECE_KNIGHT) & keep) {
+        return true;
+    }
+    if (PrecomputedData::kingAttackBitboards[square] & state.pieces(by, PIECE_KING)) {
+        return true;
+    }
+    if (Magic::rookAttacks(square, occupancy) & state.orthogonalSliders(by) & keep) {
         return true;
     }
+    return (Magic::bishopAttacks(square, occupancy) & state.diagonalSliders(by) & keep) != 0;
+}
+
+bool isPseudoLegalPawnMove(const BitboardState& state, int us, int from, int to, BBMove::Flag flag) {
+    int pawnOffset = us == 0 ? 8 : -8;
+    int lastRank = us == 0 ? 7 : 0;
+    bool toLastRank = toRow(to) == lastRank;
     
-    int dirIndex = (epCaptureSquare < friendlyKingSquare) ? 2 : 3;
-    for (int i = 0; i < PrecomputedData::numSquaresToEdge[friendlyKingSquare][dirIndex]; i++) {
-        int squareIndex = friendlyKingSquare + PrecomputedData::directionOffsets[dirIndex] * (i + 1);
-        int piece = board->square[squareIndex];
-        if (piece != PIECE_NONE) {
-            if (isColor(piece, friendlyColour)) {
-                break;
-            }
-            else {
-                int pieceType = typeOf(piece);
-                if (pieceType == PIECE_ROOK || pieceType == PIECE_QUEEN) {
-                    return true;
-                } else {
-                    break;
-                }
-            }
-        }
+    if (flag == BBMove::EnPassantCapture) {
+        int epFile = getEPFile(state.gameState);
+        return epFile >= 0 && to == 8 * (us == 0 ? 5 : 2) + epFile &&
+               getBit(PrecomputedData::pawnAttackBitboards[from][us], to);
+    }
+    if (flag == BBMove::PawnTwoForward) {
+        int startRank = us == 0 ? 1 : 6;
+        return toRow(from) == startRank && to == from + 2 * pawnOffset &&
+               !getBit(state.allPiecesBitboard, from + pawnOffset) &&
+               !getBit(state.allPiecesBitboard, to);
     }
     
-    for (int i = 0; i < 2; i++) {
-        int* pawnAttackDirs = PrecomputedData::pawnAttackDirections[friendlyColourIndex];
-        if (PrecomputedData::numSquaresToEdge[friendlyKingSquare][pawnAttackDirs[i]] > 0) {
-            int piece = board->square[friendlyKingSquare + PrecomputedData::directionOffsets[pawnAttackDirs[i]]];
-            if (piece == (PIECE_PAWN | opponentColour)) {
-                return true;
+    // Plain pawn moves and promotions; a move to the last rank must promote
+    bool isPromotion = flag >= BBMove::PromoteToQueen && flag <= BBMove::PromoteToBishop;
+    if (isPromotion != toLastRank || (flag != BBMove::None && !isPromotion)) {
+        return false;
+    }
+    if (to == from + pawnOffset) {
+        return !getBit(state.allPiecesBitboard, to);
+    }
+    return getBit(PrecomputedData::pawnAttackBitboards[from][us] & state.colorBitboards[us ^ 1], to);
+}
+
+bool isPseudoLegalCastle(const BitboardState& state, int us, int from, int to) {
+    int kingStart = us == 0 ? 4 : 60;
+    if (from != kingStart) {
+        return false;
+    }
+    
+    int friendlyRook = PIECE_ROOK | (us == 0 ? COLOR_WHITE : COLOR_BLACK);
+    uint64_t occupancy = state.allPiecesBitboard;
+    if (to == from + 2) {
+        uint32_t right = us == 0 ? CR_WHITE_K : CR_BLACK_K;
+        return (state.gameState & right) && state.square[from + 3] == friendlyRook &&
+               !getBit(occupancy, from + 1) && !getBit(occupancy, from + 2);
+    }
+    if (to == from - 2) {
+        uint32_t right = us == 0 ? CR_WHITE_Q : CR_BLACK_Q;
+        return (state.gameState & right) && state.square[from - 4] == friendlyRook &&
+               !getBit(occupancy, from - 1) && !getBit(occupancy, from - 2) && !getBit(occupancy, from - 3);
+    }
+    return false;
+}
+
+} // namespace
+
+bool isPseudoLegal(const BitboardState& state, BBMove move) {
+    if (move.value == 0 || move.flag() > BBMove::PawnTwoForward) {
+        return false;
+    }
+    
+    int us = state.whiteToMove ? 0 : 1;
+    int from = move.startSquare();
+    int to = move.targetSquare();
+    BBMove::Flag flag = move.flag();
+    
+    if (!getBit(state.colorBitboards[us], from) || getBit(state.colorBitboards[us], to)) {
+        return false;
+    }
+    
+    int pieceType = typeOf(state.square[from]);
+    if (pieceType == PIECE_PAWN) {
+        return isPseudoLegalPawnMove(state, us, from, to, flag);
+    }
+    if (flag == BBMove::Castling) {
+        return pieceType == PIECE_KING && isPseudoLegalCastle(state, us, from, to);
+    }
+    if (flag != BBMove::None) {
+        return false;
+    }
+    
+    uint64_t occupancy = state.allPiecesBitboard;
+    switch (pieceType) {
+        case PIECE_KNIGHT: return getBit(PrecomputedData::knightAttackBitboards[from], to);
+        case PIECE_KING:   return getBit(PrecomputedData::kingAttackBitboards[from], to);
+        case PIECE_BISHOP: return getBit(Magic::bishopAttacks(from, occupancy), to);
+        case PIECE_ROOK:   return getBit(Magic::rookAttacks(from, occupancy), to);
+        case PIECE_QUEEN:  return getBit(Magic::queenAttacks(from, occupancy), to);
+        default:           return false;
+    }
+}
+
+bool isLegal(const BitboardState& state, BBMove move) {
+    if (!isPseudoLegal(state, move)) {
+        return false;
+    }
+    
+    int us = state.whiteToMove ? 0 : 1;
+    int them = us ^ 1;
+    int from = move.startSquare();
+    int to = move.targetSquare();
+    
+    if (move.flag() == BBMove::Castling) {
+        // Sliders look through the king, as in the generator's attack map
+        uint64_t occupancy = state.allPiecesBitboard & ~bit(from);
+        int step = to > from ? 1 : -1;
+        for (int sq = from; sq != to + step; sq += step) {
+            if (isAttackedBy(state, sq, them, occupancy, 0)) {
+                return false;
             }
         }
+        return true;
     }
     
-    return false;
+    uint64_t captured = bit(to);
+    if (move.flag() == BBMove::EnPassantCapture) {
+        captured = bit(to + (us == 0 ? -8 : 8));
+    }
+    uint64_t occupancy = ((state.allPiecesBitboard ^ bit(from)) & ~captured) | bit(to);
+    int kingSquare = typeOf(state.square[from]) == PIECE_KING ? to : state.kingSquare[us];
+    
+    return !isAttackedBy(state, kingSquare, them, occupancy, captured);
 }
 
 } // namespace chess
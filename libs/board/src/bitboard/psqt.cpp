@@ -0,0 +1,58 @@
+#include <chess/board/bitboard/psqt.h>
+#include <chess/board/pieces/piece_const.h>
+#include <chess/AI/pieceST.h>
+
+namespace chess {
+
+namespace {
+
+using psqt_detail::SideTable;
+
+constexpr int materialValue(int pieceType) {
+    switch (pieceType) {
+        case PIECE_PAWN:   return PAWN_VALUE;
+        case PIECE_KNIGHT: return KNIGHT_VALUE;
+        case PIECE_BISHOP: return BISHOP_VALUE;
+        case PIECE_ROOK:   return ROOK_VALUE;
+        case PIECE_QUEEN:  return QUEEN_VALUE;
+        default:           return 0;
+    }
+}
+
+// Only the king has a separate endgame table
+constexpr const std::array<short, 64>* squareTable(int pieceType, bool endgame) {
+    switch (pieceType) {
+        case PIECE_PAWN:   return &PawnTable;
+        case PIECE_KNIGHT: return &KnightTable;
+        case PIECE_BISHOP: return &BishopTable;
+        case PIECE_ROOK:   return &RookTable;
+        case PIECE_QUEEN:  return &QueenTable;
+        case PIECE_KING:   return endgame ? &KingTableEndGame : &KingMiddleGame;
+        default:           return nullptr;
+    }
+}
+
+// Black pieces enter negated
+constexpr std::array<SideTable, 2> buildTables() {
+    std::array<SideTable, 2> tables{};
+    for (int pieceType = 0; pieceType < 8; ++pieceType) {
+        const std::array<short, 64>* mgTable = squareTable(pieceType, false);
+        const std::array<short, 64>* egTable = squareTable(pieceType, true);
+        if (!mgTable) {
+            continue;
+        }
+        int material = materialValue(pieceType);
+        for (int square = 0; square < 64; ++square) {
+            int white = square ^ 56;
+            tables[0][pieceType][square] = makeScore(material + (*mgTable)[white], material + (*egTable)[white]);
+            tables[1][pieceType][square] = makeScore(-(material + (*mgTable)[square]), -(material + (*egTable)[square]));
+        }
+    }
+    return tables;
+}
+
+} // namespace
+
+const std::array<SideTable, 2> PSQT = buildTables();
+
+} // namespace chess
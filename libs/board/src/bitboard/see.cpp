@@ -0,0 +1,172 @@
+#include <chess/board/bitboard/see.h>
+#include <chess/board/bitboard/precomputed_data.h>
+#include <chess/board/bitboard/magic.h>
+#include <chess/board/bitboard/bitboard.h>
+#include <chess/board/pieces/piece_const.h>
+#include <algorithm>
+
+namespace chess {
+
+namespace {
+
+// Least valuable piece first; the king goes last
+constexpr int CAPTURE_ORDER[6] = {PIECE_PAWN, PIECE_KNIGHT, PIECE_BISHOP, PIECE_ROOK, PIECE_QUEEN, PIECE_KING};
+
+int promotionType(BBMove::Flag flag) {
+    switch (flag) {
+        case BBMove::PromoteToQueen:  return PIECE_QUEEN;
+        case BBMove::PromoteToRook:   return PIECE_ROOK;
+        case BBMove::PromoteToBishop: return PIECE_BISHOP;
+        case BBMove::PromoteToKnight: return PIECE_KNIGHT;
+        default:                      return PIECE_NONE;
+    }
+}
+
+} // namespace
+
+uint64_t attackersTo(const BitboardState& state, int square, uint64_t occupancy) {
+    uint64_t attackers =
+        (PrecomputedData::pawnAttackBitboards[square][1] & state.pieces(0, PIECE_PAWN)) |
+        (PrecomputedData::pawnAttackBitboards[square][0] & state.pieces(1, PIECE_PAWN)) |
+        (PrecomputedData::knightAttackBitboards[square] & (state.pieces(0, PIECE_KNIGHT) | state.pieces(1, PIECE_KNIGHT))) |
+        (PrecomputedData::kingAttackBitboards[square] & (state.pieces(0, PIECE_KING) | state.pieces(1, PIECE_KING))) |
+        (Magic::rookAttacks(square, occupancy) & (state.orthogonalSliders(0) | state.orthogonalSliders(1))) |
+        (Magic::bishopAttacks(square, occupancy) & (state.diagonalSliders(0) | state.diagonalSliders(1)));
+    return attackers & occupancy;
+}
+
+int see(const BitboardState& state, BBMove move) {
+    if (move.flag() == BBMove::Castling) {
+        return 0;
+    }
+    
+    int from = move.startSquare();
+    int to = move.targetSquare();
+    uint64_t occupancy = state.allPiecesBitboard ^ bit(from);
+    
+    // gain[d]: material balance for the side making capture d, if the
+    // exchange stopped right after it
+    int gain[32];
+    int d = 0;
+    int nextVictimType = typeOf(state.square[from]);
+    
+    if (move.flag() == BBMove::EnPassantCapture) {
+        gain[0] = SEE_PIECE_VALUES[PIECE_PAWN];
+        occupancy ^= bit(to + (state.whiteToMove ? -8 : 8));
+    } else {
+        gain[0] = SEE_PIECE_VALUES[typeOf(state.square[to])];
+    }
+    
+    int promoted = promotionType(move.flag());
+    if (promoted != PIECE_NONE) {
+        gain[0] += SEE_PIECE_VALUES[promoted] - SEE_PIECE_VALUES[PIECE_PAWN];
+        nextVictimType = promoted;
+    }
+    
+    int side = state.whiteToMove ? 1 : 0;
+    uint64_t attackers = attackersTo(state, to, occupancy);
+    
+    while (true) {
+        uint64_t sideAttackers = attackers & state.colorBitboards[side];
+        if (!sideAttackers) {
+            break;
+        }
+        
+        int attackerType = PIECE_NONE;
+        uint64_t attacker = 0;
+        for (int pieceType : CAPTURE_ORDER) {
+            attacker = sideAttackers & state.pieces(side, pieceType);
+            if (attacker) {
+                attackerType = pieceType;
+                break;
+            }
+        }
+        
+        // The king may only take last, when nothing defends the square
+        if (attackerType == PIECE_KING && (attackers & state.colorBitboards[side ^ 1])) {
+            break;
+        }
+        
+        ++d;
+        gain[d] = SEE_PIECE_VALUES[nextVictimType] - gain[d - 1];
+        
+        occupancy ^= bit(getLSB(attacker));
+        attackers = attackersTo(state, to, occupancy);
+        nextVictimType = attackerType;
+        side ^= 1;
+    }
+    
+    // Walk back up the exchange: each side recaptures only if that beats
+    // stopping where it is
+    while (d > 0) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
+        --d;
+    }
+    return gain[0];
+}
+
+bool seeGE(const BitboardState& state, BBMove move, int threshold) {
+    int from = move.startSquare();
+    int to = move.targetSquare();
+    if (move.flag() == BBMove::Castling || move.isPromotion() || move.flag() == BBMove::EnPassantCapture) {
+        return see(state, move) >= threshold;
+    }
+    
+    // Winning less than threshold even if the capture goes unanswered
+    int balance = SEE_PIECE_VALUES[typeOf(state.square[to])] - threshold;
+    if (balance < 0) {
+        return false;
+    }
+    // Still at least threshold after losing the capturing piece
+    if (balance - SEE_PIECE_VALUES[typeOf(state.square[from])] >= 0) {
+        return true;
+    }
+    return see(state, move) >= threshold;
+}
+
+bool givesCheck(const BitboardState& state, BBMove move) {
+    int us = state.whiteToMove ? 0 : 1;
+    int kingSquare = state.kingSquare[us ^ 1];
+    int from = move.startSquare();
+    int to = move.targetSquare();
+    int pieceType = move.isPromotion() ? promotionType(move.flag()) : typeOf(state.square[from]);
+
+    uint64_t occupancy = (state.allPiecesBitboard ^ bit(from)) | bit(to);
+    uint64_t orthogonal = state.orthogonalSliders(us) & ~bit(from);
+    uint64_t diagonal = state.diagonalSliders(us) & ~bit(from);
+
+    if (move.flag() == BBMove::EnPassantCapture) {
+        occupancy ^= bit(to + (us == 0 ? -8 : 8));
+    } else if (move.flag() == BBMove::Castling) {
+        int rookFrom, rookTo;
+        if (to > from) {
+            rookFrom = us == 0 ? 7 : 63;
+            rookTo = us == 0 ? 5 : 61;
+        } else {
+            rookFrom = us == 0 ? 0 : 56;
+            rookTo = us == 0 ? 3 : 59;
+        }
+        occupancy ^= bit(rookFrom) | bit(rookTo);
+        orthogonal ^= bit(rookFrom) | bit(rookTo);
+    }
+
+    // Direct checks by a pawn or knight; a slider is added to its set on
+    // the target square and found with the uncovered ones below
+    switch (pieceType) {
+        case PIECE_PAWN:
+            if (PrecomputedData::pawnAttackBitboards[to][us] & bit(kingSquare)) return true;
+            break;
+        case PIECE_KNIGHT:
+            if (PrecomputedData::knightAttackBitboards[to] & bit(kingSquare)) return true;
+            break;
+        case PIECE_BISHOP: diagonal |= bit(to); break;
+        case PIECE_ROOK:   orthogonal |= bit(to); break;
+        case PIECE_QUEEN:  diagonal |= bit(to); orthogonal |= bit(to); break;
+        default: break;
+    }
+
+    return (Magic::rookAttacks(kingSquare, occupancy) & orthogonal) ||
+           (Magic::bishopAttacks(kingSquare, occupancy) & diagonal);
+}
+
+} // namespace chess
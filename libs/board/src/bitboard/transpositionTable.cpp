@@ -1,23 +1,21 @@
 #include <chess/board/bitboard/transpositionTable.h>
-#include <chess/board/boardBB.h>
-#include <chess/board/bitboard/board_state.h>
 #include <chess/board/bitboard/move.h>
 #include <chess/utils/logger.h>
 #include <algorithm>
 #include <iostream>
 
-TranspositionTable::TranspositionTable(BoardBB& b, size_t sizeInMB)
-    : board(b), isEnabled(true) {
+TranspositionTable::TranspositionTable(size_t sizeInMB)
+    : isEnabled(true) {
     
     size_t sizeInBytes = sizeInMB * 1024 * 1024;
-    numEntries = sizeInBytes / sizeof(TTEntry);
+    size_t numClusters = sizeInBytes / sizeof(TTCluster);
     
-    if (numEntries < 2) {
-        numEntries = 2;
+    if (numClusters < 2) {
+        numClusters = 2;
     }
     
     size_t powerOf2 = 1;
-    while (powerOf2 < numEntries) {
+    while (powerOf2 < numClusters) {
         powerOf2 *= 2;
     }
     tableSize = powerOf2;
@@ -26,127 +24,117 @@ TranspositionTable::TranspositionTable(BoardBB& b, size_t sizeInMB)
         tableSize = 1024;
     }
     
-    table.resize(tableSize);
-    numEntries = tableSize;
+    // TTCluster is alignas(64), so each cluster starts a cache line
+    table = std::make_unique<TTCluster[]>(tableSize);
+    numEntries = tableSize * TTCluster::NUM_ENTRIES;
     
-    LOG_INFO(std::string("Transposition table initialized with ") + 
-             std::to_string(tableSize) + " entries (" + 
-             std::to_string((tableSize * sizeof(TTEntry)) / (1024 * 1024)) + " MB)");
+    LOG_INFO(std::string("Transposition table initialized with ") +
+             std::to_string(numEntries) + " entries in " + std::to_string(tableSize) + " clusters (" +
+             std::to_string((tableSize * sizeof(TTCluster)) / (1024 * 1024)) + " MB)");
 }
 
 TranspositionTable::~TranspositionTable() {
-    table.clear();
+    table.reset();
 }
 
-uint64_t TranspositionTable::getIndex() const {
-    uint64_t key = board.getLastState();
-    
+uint64_t TranspositionTable::getIndex(uint64_t key) const {
     // Use bitwise AND with (tableSize - 1) for fast modulo
     // This works because tableSize is a power of 2
-    uint64_t index = key & (tableSize - 1);
-    
-    if (index >= table.size()) {
-        std::cerr << "[TT INDEX ERROR] Index " << index << " >= table size " << table.size() << std::endl;
-    }
-    
-    return index;
+    return key & (tableSize - 1);
 }
 
-void TranspositionTable::storeEval(int depth, int plySearched, int eval, int evalType, const chess::BBMove& move) {
-    if (!isEnabled) return;
-    
-    uint64_t index = getIndex();
-    uint64_t zobristKey = board.getLastState();
-    
-    int correctedEval = correctMateScoreForStorage(eval, plySearched);
-    
-    TTEntry& entry = table[index];
-    
-    bool shouldReplace = (entry.key == 0) || 
-                        (entry.key == zobristKey) || 
-                        (depth >= entry.depth);
-    
-    if (shouldReplace) {
-        entry.key = zobristKey;
-        entry.value = correctedEval;
-        entry.depth = depth;
-        entry.nodeType = static_cast<byte>(evalType);
-        entry.move = move;
-        
-        LOG_DEBUG(std::string("TT Store: depth=") + std::to_string(depth) + 
-                  " eval=" + std::to_string(eval) + 
-                  " type=" + std::to_string(evalType));
+uint64_t TranspositionTable::findEntry(uint64_t key) const {
+    const TTCluster& cluster = table[getIndex(key)];
+    uint16_t keyCheck = TTEntry::keyCheckOf(key);
+    
+    for (const TTEntry& entry : cluster.entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if (data != 0 && TTEntry::keyCheck(data) == keyCheck) {
+            return data;
+        }
     }
+    return 0;
 }
 
-chess::BBMove TranspositionTable::getStoredMove() const {
-    if (!isEnabled) return chess::BBMove();
-    
-    uint64_t index = getIndex();
-    
-    if (index >= table.size()) {
-        std::cerr << "[TT getStoredMove ERROR] Index " << index << " >= table size " << table.size() << " - RETURNING INVALID MOVE!" << std::endl;
-        return chess::BBMove();
-    }
-    
-    const TTEntry& entry = table[index];
-    
-    uint64_t zobristKey = board.getLastState();
+// Each entry is one relaxed atomic word, so it is always seen whole; two
+// threads storing into the same cluster at once can only cost an entry
+void TranspositionTable::storeEval(uint64_t key, int depth, int plySearched, int eval, int evalType, const chess::BBMove& move) {
+    if (!isEnabled) return;
     
-    if (entry.key == zobristKey) {
-        return entry.move;
+    TTCluster& cluster = table[getIndex(key)];
+    uint16_t keyCheck = TTEntry::keyCheckOf(key);
+    chess::BBMove storedMove = move;
+    
+    // The key's own entry or an empty one if there is either, otherwise the
+    // entry least worth keeping: shallow, and older by AGE_DEPTH_WEIGHT
+    // plies per generation
+    TTEntry* replace = nullptr;
+    int lowestWorth = 0;
+    for (TTEntry& entry : cluster.entries) {
+        uint64_t oldData = entry.data.load(std::memory_order_relaxed);
+        if (oldData == 0 || TTEntry::keyCheck(oldData) == keyCheck) {
+            if (oldData != 0) {
+                // A shallower bound from this search, reached again through a
+                // transposition, is worth less than what is already stored
+                bool keepOld = evalType != EXACT && TTEntry::generation(oldData) == generation &&
+                               depth < TTEntry::depth(oldData) - SAME_KEY_DEPTH_MARGIN;
+                if (keepOld) {
+                    return;
+                }
+                // A result without a best move (fail low) keeps the one found before
+                if (storedMove.value == 0) {
+                    storedMove = TTEntry::move(oldData);
+                }
+            }
+            replace = &entry;
+            break;
+        }
+        
+        int age = (generation - TTEntry::generation(oldData)) & TTEntry::GENERATION_MASK;
+        int worth = TTEntry::depth(oldData) - AGE_DEPTH_WEIGHT * age;
+        if (!replace || worth < lowestWorth) {
+            replace = &entry;
+            lowestWorth = worth;
+        }
     }
     
-    return chess::BBMove();
+    int correctedEval = correctMateScoreForStorage(eval, plySearched);
+    uint64_t data = TTEntry::pack(keyCheck, compressValue(correctedEval), depth, evalType, generation, storedMove);
+    replace->data.store(data, std::memory_order_relaxed);
 }
 
-int TranspositionTable::getStoredValue() const {
-    if (!isEnabled) return 0;
-    
-    uint64_t index = getIndex();
-    
-    if (index >= table.size()) {
-        std::cerr << "[TT getStoredValue ERROR] Index " << index << " >= table size " << table.size() << std::endl;
-        return 0;
-    }
+chess::BBMove TranspositionTable::getStoredMove(uint64_t key) const {
+    if (!isEnabled) return chess::BBMove();
     
-    const TTEntry& entry = table[index];
-    return entry.value;
+    uint64_t data = findEntry(key);
+    return data != 0 ? TTEntry::move(data) : chess::BBMove();
 }
 
-int TranspositionTable::probeEval(int depth, int plyFromRoot, int alpha, int beta) {
+int TranspositionTable::probeEval(uint64_t key, int depth, int plyFromRoot, int alpha, int beta) const {
     if (!isEnabled) return LOOKUP_FAILED;
     
-    uint64_t index = getIndex();
-    const TTEntry& entry = table[index];
-    
-    uint64_t zobristKey = board.getLastState();
-    
-    if (entry.key != zobristKey) {
+    uint64_t data = findEntry(key);
+    if (data == 0) {
         return LOOKUP_FAILED;
     }
     
-    if (entry.depth < depth) {
+    int entryDepth = TTEntry::depth(data);
+    if (entryDepth < depth) {
         return LOOKUP_FAILED;
     }
     
-    int correctedValue = correctMateScoreForRetrieval(entry.value, plyFromRoot);
+    int nodeType = TTEntry::nodeType(data);
+    int correctedValue = correctMateScoreForRetrieval(expandValue(TTEntry::value(data)), plyFromRoot);
     
-    if (entry.nodeType == EXACT) {
-        LOG_DEBUG(std::string("TT Hit (EXACT): depth=") + std::to_string(entry.depth) + 
-                  " value=" + std::to_string(correctedValue));
+    if (nodeType == EXACT) {
         return correctedValue;
     }
     
-    if (entry.nodeType == LOWER_BOUND && correctedValue >= beta) {
-        LOG_DEBUG(std::string("TT Hit (LOWER_BOUND): depth=") + std::to_string(entry.depth) + 
-                  " value=" + std::to_string(correctedValue) + " >= beta=" + std::to_string(beta));
+    if (nodeType == LOWER_BOUND && correctedValue >= beta) {
         return correctedValue;
     }
     
-    if (entry.nodeType == UPPER_BOUND && correctedValue <= alpha) {
-        LOG_DEBUG(std::string("TT Hit (UPPER_BOUND): depth=") + std::to_string(entry.depth) + 
-                  " value=" + std::to_string(correctedValue) + " <= alpha=" + std::to_string(alpha));
+    if (nodeType == UPPER_BOUND && correctedValue <= alpha) {
         return correctedValue;
     }
     
@@ -171,7 +159,41 @@ int TranspositionTable::correctMateScoreForRetrieval(int score, int numPlyFromRo
     return score;
 }
 
+// Ordinary scores stay well inside +-MAX_STORED_SCORE; mate scores, at
+// least MATE_SCORE - MAX_MATE_DEPTH, go to STORED_MATE_BASE and up
+namespace {
+constexpr int MAX_STORED_SCORE = 30000;
+constexpr int STORED_MATE_BASE = 31000;
+}
+
+int16_t TranspositionTable::compressValue(int score) {
+    constexpr int mateThreshold = MATE_SCORE - MAX_MATE_DEPTH;
+    if (score >= mateThreshold) {
+        return static_cast<int16_t>(STORED_MATE_BASE + std::min(score, MATE_SCORE) - mateThreshold);
+    }
+    if (score <= -mateThreshold) {
+        return static_cast<int16_t>(-(STORED_MATE_BASE + std::min(-score, MATE_SCORE) - mateThreshold));
+    }
+    return static_cast<int16_t>(std::clamp(score, -MAX_STORED_SCORE, MAX_STORED_SCORE));
+}
+
+int TranspositionTable::expandValue(int16_t stored) {
+    constexpr int mateThreshold = MATE_SCORE - MAX_MATE_DEPTH;
+    if (stored >= STORED_MATE_BASE) {
+        return stored - STORED_MATE_BASE + mateThreshold;
+    }
+    if (stored <= -STORED_MATE_BASE) {
+        return -(-stored - STORED_MATE_BASE + mateThreshold);
+    }
+    return stored;
+}
+
 void TranspositionTable::clear() {
-    std::fill(table.begin(), table.end(), TTEntry());
+    for (size_t i = 0; i < tableSize; ++i) {
+        for (TTEntry& entry : table[i].entries) {
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
     LOG_INFO("Transposition table cleared");
-}
\ No newline at end of file
+}
@@ -11,6 +11,7 @@
 #include <chess/board/bitboard/move_generator_bb.h>
 #include <chess/board/bitboard/move.h>
 #include <chess/board/bitboard/move_exec.h>
+#include <chess/board/bitboard/position_history.h>
 #include <chess/board/pieces/piece_const.h>
 #include <chess/AI/ai_bb.h>
 
@@ -34,7 +35,8 @@ BoardBB::BoardBB(int width, int height, float offSet) {
     chess::initBitboardSystem();    
     bbState = std::make_unique<chess::BitboardState>();
     bbGenerator = std::make_unique<chess::MoveGeneratorBB>();
-    moveExecutor = std::make_unique<chess::BBMoveExecutor>(*bbState);
+    history = std::make_unique<chess::PositionHistory>();
+    moveExecutor = std::make_unique<chess::BBMoveExecutor>(*bbState, history.get());
 }
 
 BoardBB::~BoardBB() {
@@ -57,8 +59,8 @@ BoardBB::BoardBB(const BoardBB& other)
         currentPlayer(other.currentPlayer),
         halfMoveClock(other.halfMoveClock),
         fullMoveNumber(other.fullMoveNumber),
-        whiteMoves(other.whiteMoves),
-        blackMoves(other.blackMoves)
+        numWhiteMoves(other.numWhiteMoves),
+        numBlackMoves(other.numBlackMoves)
     {
         // Deep copy std::unique_ptr members
         if (other.boardRenderer) {
@@ -72,8 +74,12 @@ BoardBB::BoardBB(const BoardBB& other)
         if (other.bbGenerator) {
             bbGenerator = std::make_unique<chess::MoveGeneratorBB>(*other.bbGenerator);
         }
-        if (other.moveExecutor) {
-            moveExecutor = std::make_unique<chess::BBMoveExecutor>(*other.moveExecutor);
+        if (other.history) {
+            history = std::make_unique<chess::PositionHistory>(*other.history);
+        }
+        if (bbState) {
+            // Bind to this board's own state rather than copying other's executor
+            moveExecutor = std::make_unique<chess::BBMoveExecutor>(*bbState, history.get());
         }
 
         for (int i = 0; i < 8; ++i) {
@@ -89,6 +95,7 @@ BoardBB::BoardBB(const BoardBB& other)
 
 void BoardBB::loadFEN(const std::string& fen, SDL_Renderer* gameRenderer){
     bbState->loadFromFEN(fen);
+    history->clear();
     currentPlayer = bbState->whiteToMove ? WHITE : BLACK;
     if (gameRenderer) {
         uiRenderer = gameRenderer;
@@ -96,6 +103,14 @@ void BoardBB::loadFEN(const std::string& fen, SDL_Renderer* gameRenderer){
     }
 }
 
+void BoardBB::copyPositionFrom(const BoardBB& other) {
+    *bbState = *other.bbState;
+    *history = *other.history;
+    currentPlayer = bbState->whiteToMove ? WHITE : BLACK;
+    halfMoveClock = other.halfMoveClock;
+    fullMoveNumber = other.fullMoveNumber;
+}
+
 void BoardBB::initializeBoard(SDL_Renderer* gameRenderer) {
     for (auto& row : pieceGrid) {
         for (auto &cell : row) cell.reset();
@@ -163,6 +178,14 @@ void BoardBB::undoMove(const chess::BBMove& move, chess::UndoState& undo) {
     if (uiRenderer) syncUIFromBBState(uiRenderer);
 }
 
+chess::UndoState BoardBB::executeNullMove() {
+    return moveExecutor->makeNullMove();
+}
+
+void BoardBB::undoNullMove(const chess::UndoState& undo) {
+    moveExecutor->unmakeNullMove(undo);
+}
+
 void BoardBB::syncUIFromBBState(SDL_Renderer* gameRenderer) {
     if (!bbState) return;
 
@@ -191,11 +214,15 @@ void BoardBB::syncUIFromBBState(SDL_Renderer* gameRenderer) {
     for (int colorIdx = 0; colorIdx <= 1; ++colorIdx) {
         Color color = (colorIdx == 0) ? WHITE : BLACK;
 
-        for (int sq : bbState->pawns[colorIdx].squares) addPieceAt(sq, color, PAWN);
-        for (int sq : bbState->knights[colorIdx].squares) addPieceAt(sq, color, KNIGHT);
-        for (int sq : bbState->bishops[colorIdx].squares) addPieceAt(sq, color, BISHOP);
-        for (int sq : bbState->rooks[colorIdx].squares) addPieceAt(sq, color, ROOK);
-        for (int sq : bbState->queens[colorIdx].squares) addPieceAt(sq, color, QUEEN);
+        auto addPieces = [&](int pieceType, PieceType type) {
+            uint64_t bb = bbState->pieces(colorIdx, pieceType);
+            while (bb) addPieceAt(chess::popLSB(bb), color, type);
+        };
+        addPieces(chess::PIECE_PAWN, PAWN);
+        addPieces(chess::PIECE_KNIGHT, KNIGHT);
+        addPieces(chess::PIECE_BISHOP, BISHOP);
+        addPieces(chess::PIECE_ROOK, ROOK);
+        addPieces(chess::PIECE_QUEEN, QUEEN);
         int ksq = bbState->kingSquare[colorIdx];
         if (ksq >= 0) addPieceAt(ksq, color, KING);
     }
@@ -238,31 +265,29 @@ SDL_FRect BoardBB::getSquareRect(int r, int c) const {
 std::vector<chess::BBMove> BoardBB::getAllLegalMoves(Color color) const {
     bool origSide = bbState->whiteToMove;
     bbState->whiteToMove = (color == WHITE);
+    std::vector<chess::BBMove> moves = bbGenerator->generateMoves(*bbState);
+    bbState->whiteToMove = origSide;
+    
     if (color == WHITE) {
-        whiteMoves = bbGenerator->generateMoves(*bbState);
-        bbState->whiteToMove = origSide;
-        return whiteMoves;
+        numWhiteMoves = moves.size();
     } else {
-        blackMoves = bbGenerator->generateMoves(*bbState);
-        bbState->whiteToMove = origSide;
-        return blackMoves;
+        numBlackMoves = moves.size();
     }
+    return moves;
 }
 
 
 
 int64_t BoardBB::getLastState() const {
-    // Use zobristKey directly instead of zobristHistory
-    // zobristHistory is empty during search, but zobristKey is always valid
     return static_cast<int64_t>(bbState->zobristKey);
 }
 
 bool BoardBB::isCheckMate(Color color) {
-    if (color == WHITE && bbState->whiteToMove == true && whiteMoves.empty() 
+    if (color == WHITE && bbState->whiteToMove == true && numWhiteMoves == 0 
         && bbGenerator->getInCheck()) {
         return true;
     }
-    if (color == BLACK && bbState->whiteToMove == false && blackMoves.empty() 
+    if (color == BLACK && bbState->whiteToMove == false && numBlackMoves == 0 
         && bbGenerator->getInCheck()) {
         return true;
     }
@@ -270,11 +295,11 @@ bool BoardBB::isCheckMate(Color color) {
 }
 
 bool BoardBB::isStaleMate(Color color) {
-    if (color == WHITE && bbState->whiteToMove == true && whiteMoves.empty() 
+    if (color == WHITE && bbState->whiteToMove == true && numWhiteMoves == 0 
         && !bbGenerator->getInCheck()) {
         return true;
     }
-    if (color == BLACK && bbState->whiteToMove == false && blackMoves.empty() 
+    if (color == BLACK && bbState->whiteToMove == false && numBlackMoves == 0 
         && !bbGenerator->getInCheck()) {
         return true;
     }
@@ -175,7 +175,8 @@ void GameLogicBB::update(BoardBB& board) {
 
             if (!aiSearchRunning.load()) {
                 aiSearchRunning.store(true);
-                LOG_INFO("GameLogicBB: Starting AI search at depth " + std::to_string(aiSearchDepth));
+                LOG_INFO("GameLogicBB: Starting AI search at depth " + std::to_string(aiSearchDepth) +
+                         (aiMoveTimeMs > 0 ? ", " + std::to_string(aiMoveTimeMs) + " ms" : std::string()));
                 std::string currentFEN;
                 try {
                     currentFEN = board.getCurrentFEN();
@@ -190,17 +191,22 @@ void GameLogicBB::update(BoardBB& board) {
                 }
                 
                 std::shared_ptr<AI_BB> aiPtr = ai;
-                int depth = aiSearchDepth;
+                SearchLimits limits;
+                limits.depth = aiSearchDepth;
+                limits.moveTimeMs = aiMoveTimeMs;
                 
-                aiFuture = std::async(std::launch::async, [aiPtr, currentFEN, depth]() -> std::pair<std::pair<chess::BBMove, int>, std::string> {
+                // Snapshot position and game history here; the UI keeps
+                // using board while the search runs
+                auto localBoard = std::make_shared<BoardBB>(100, 100, 30.0f);
+                localBoard->copyPositionFrom(board);
+                
+                aiFuture = std::async(std::launch::async, [aiPtr, localBoard, currentFEN, limits]() -> std::pair<std::pair<chess::BBMove, int>, std::string> {
                     try {
-                        BoardBB localBoard(100, 100, 30.0f);
-                        localBoard.loadFEN(currentFEN, nullptr);
-                        
-                        // sequential search (parallel has issues with mate scores)
-                        auto res = aiPtr->getSearchResult(localBoard, depth);
+                        // Lazy SMP over the AI's threads; sequential with one thread
+                        auto res = aiPtr->getSearchResultParallel(*localBoard, limits);
                         
-                        LOG_INFO("GameLogicBB: AI search complete. Move value: " + std::to_string(res.first.value) + ", Eval: " + std::to_string(res.second));
+                        LOG_INFO("GameLogicBB: AI search complete. Move value: " + std::to_string(res.first.value) + ", Eval: " + std::to_string(res.second) +
+                                 ", Depth: " + std::to_string(aiPtr->getCompletedDepth()) + ", Time: " + std::to_string(aiPtr->getElapsedMs()) + " ms");
                         return {res, currentFEN};
                     } catch (const std::exception& e) {
                         LOG_ERROR("GameLogicBB: AI search exception: " + std::string(e.what()));
@@ -238,9 +244,10 @@ void GameLogicBB::update(BoardBB& board) {
     }
 }
 
-void GameLogicBB::setAISettings(int searchDepth, unsigned threadCount) {
+void GameLogicBB::setAISettings(int searchDepth, unsigned threadCount, int moveTimeMs) {
     aiSearchDepth = searchDepth;
     aiThreadCount = threadCount;
+    aiMoveTimeMs = moveTimeMs;
 }
 
 void GameLogicBB::setAI(std::shared_ptr<AI_BB> aiInstance, Color aiColorIn) {
@@ -52,6 +52,7 @@ private:
     std::shared_ptr<AI> aiInstance;
     std::shared_ptr<class AI_BB> aiInstanceBB;
     int aiSearchDepth = 4;
+    int aiMoveTimeMs = 3000;    // per-move cap, 0 for none
     unsigned aiThreadCount = std::thread::hardware_concurrency();
     Color aiBBColor = NO_COLOR;
     
@@ -210,8 +210,9 @@ void Screen::resetGame() {
         // Re-attach AI to the new GameLogicBB instance
         if (aiEnabled && aiInstanceBB) {
             Color aiColor = (playerColor == WHITE) ? BLACK : WHITE;
+            aiInstanceBB->newGame();
             gameLogicBB->setAI(aiInstanceBB, aiColor);
-            gameLogicBB->setAISettings(aiSearchDepth, aiThreadCount == 0 ? 1u : aiThreadCount);
+            gameLogicBB->setAISettings(aiSearchDepth, aiThreadCount == 0 ? 1u : aiThreadCount, aiMoveTimeMs);
         }
     } else {
         gameBoard->setFlipped(playerColor == BLACK);
@@ -258,7 +259,7 @@ void Screen::setupAI(bool enabled, Color humanColor) {
                 if (gameLogicBB && aiInstanceBB) {
                     LOG_INFO("Screen: Attaching AI_BB to GameLogicBB for color " + std::string(aiColor == WHITE ? "WHITE" : "BLACK"));
                     gameLogicBB->setAI(aiInstanceBB, aiColor);
-                    gameLogicBB->setAISettings(aiSearchDepth, aiThreadCount == 0 ? 1u : aiThreadCount);
+                    gameLogicBB->setAISettings(aiSearchDepth, aiThreadCount == 0 ? 1u : aiThreadCount, aiMoveTimeMs);
                     aiBBColor = aiColor;
                 } else {
                     LOG_ERROR("Screen: Failed to attach AI - gameLogicBB=" + std::string(gameLogicBB ? "valid" : "null") + ", aiInstanceBB=" + std::string(aiInstanceBB ? "valid" : "null"));
@@ -153,9 +153,10 @@ void Logger::shutdown() {
 }
 
 void Logger::log(LogLevel level, const std::string& msg, const char* file, int line) {
-    // Measure Logger::log overhead
-    g_profiler.startTimer("logger_log_total");
     std::lock_guard<std::mutex> lock(s_mutex);
+    // Measure Logger::log overhead. Inside the lock: the profiler is not
+    // thread safe and search threads may log too.
+    g_profiler.startTimer("logger_log_total");
 
     // Silent mode
     if (s_silent) {
@@ -165,6 +166,7 @@ void Logger::log(LogLevel level, const std::string& msg, const char* file, int l
 
     // Check if we should log this level
     if (level < s_minLevel) {
+        g_profiler.endTimer("logger_log_total");
         return;
     }
     